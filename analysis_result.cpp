@@ -61,6 +61,7 @@ nlohmann::json AnalysisResult::to_json() const {
         anom.push_back(safe_str(s, "anomalies[]"));
     }
     j["anomalies"] = anom;
+    j["anomaly_scores"] = anomaly_scores;
     // 多维聚类结果
     nlohmann::json clusters_json = nlohmann::json::array();
     for (const auto& c : clusters) {
@@ -69,6 +70,7 @@ nlohmann::json AnalysisResult::to_json() const {
         cj["member_indices"] = c.member_indices;
         cj["cluster_total"] = c.cluster_total;
         cj["avg_amount"] = c.avg_amount;
+        if (!c.centroid.empty()) cj["centroid"] = c.centroid;
         clusters_json.push_back(cj);
     }
     j["clusters"] = clusters_json;
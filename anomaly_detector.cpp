@@ -1,52 +1,193 @@
 #include "include/anomaly_detector.h"
+#include "include/isolation_forest.h"
+#include "include/quantile.h"
+#include "include/parallel.h"
+#include "include/string_interner.h"
+#include "include/stl.h"
+#include "include/date_util.h"
 #include <algorithm>
-#include <random>
-#include <set>
+#include <cmath>
 
-// 简单的异常检测实现，模拟 Isolation Forest 的思想
-// 通过随机划分数据，异常点通常更容易被“隔离”
-std::vector<size_t> AnomalyDetector::detect(const std::vector<Record>& records, double contamination) {
+// Isolation Forest 异常检测，特征见 FeatureMatrix：金额/单价/数量、星期、类别内 z-score、商品频率，
+// 既能隔离全局的高/低金额，也能发现相对本类别或购买习惯异常的记录
+std::vector<size_t> AnomalyDetector::detect(const std::vector<Record>& records, double contamination, std::vector<double>* scores) {
+    if (scores) scores->clear();
+    if (records.empty() || contamination <= 0 || contamination >= 1) return {};
+    return detect(build_feature_matrix(records), contamination, scores);
+}
+
+std::vector<size_t> AnomalyDetector::detect(const FeatureMatrix& features, double contamination, std::vector<double>* scores) {
     std::vector<size_t> anomalies_indices;
-    if (records.empty() || contamination <= 0 || contamination >= 1) {
+    if (scores) scores->clear();
+    if (features.rows == 0 || contamination <= 0 || contamination >= 1) {
         return anomalies_indices;
     }
 
-    // 提取金额数据
-    std::vector<double> amounts;
-    for (const auto& r : records) {
-        amounts.push_back(r.amount);
-    }
+    IsolationForest forest;
+    forest.fit(features.data(), features.rows, features.dim);
+    std::vector<double> s = forest.score(features.data(), features.rows);
 
-    // 计算异常点的数量
-    size_t num_anomalies = static_cast<size_t>(records.size() * contamination);
-    if (num_anomalies == 0 && records.size() > 0) num_anomalies = 1; // 至少检测一个
-    if (num_anomalies >= records.size()) num_anomalies = records.size() - 1; // 不能所有都是异常
+    // 阈值取得分的 (1 - contamination) 分位数；得分不超过 0.5 的记录与常态无异，不标记
+    std::vector<double> work = s;
+    const double threshold = select_quantiles(work, {1.0 - contamination})[0];
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] >= threshold && s[i] > 0.5) anomalies_indices.push_back(i);
+    }
+    std::sort(anomalies_indices.begin(), anomalies_indices.end(), [&](size_t a, size_t b) {
+        return s[a] != s[b] ? s[a] > s[b] : a < b;
+    });
+    if (scores) *scores = std::move(s);
+    return anomalies_indices;
+}
 
-    // 使用一个简单的启发式方法：金额离群值
-    // 这里简化为找出金额最大（或最小）的N个点作为异常
-    // 更复杂的实现会涉及随机树构建和路径长度计算
+GroupedAnomalies AnomalyDetector::detect_grouped(const std::vector<Record>& records, const FeatureMatrix& features, GroupBy by,
+                                                 double contamination, size_t min_group) {
+    GroupedAnomalies out;
+    const size_t n = features.rows, dim = features.dim;
+    if (n == 0 || n != records.size() || contamination <= 0 || contamination >= 1) return out;
 
-    // 创建 (amount, index) 对，方便排序后获取原始索引
-    std::vector<std::pair<double, size_t>> indexed_amounts;
-    for (size_t i = 0; i < amounts.size(); ++i) {
-        indexed_amounts.push_back({amounts[i], i});
+    // 1. 分组键驻留为整数；记录数不足 min_group 的键并入同一个剩余组
+    StringInterner keys;
+    std::vector<uint32_t> key_of(n);
+    for (size_t i = 0; i < n; ++i) key_of[i] = keys.intern(by == GroupBy::Type ? records[i].type : records[i].product_name);
+    std::vector<size_t> key_count(keys.size(), 0);
+    for (uint32_t k : key_of) key_count[k]++;
+    std::vector<uint32_t> group_of_key(keys.size());
+    uint32_t rest = UINT32_MAX;
+    for (uint32_t k = 0; k < keys.size(); ++k) {
+        if (key_count[k] >= min_group) {
+            group_of_key[k] = static_cast<uint32_t>(out.group_names.size());
+            out.group_names.push_back(keys.name(k));
+        } else {
+            if (rest == UINT32_MAX) {
+                rest = static_cast<uint32_t>(out.group_names.size());
+                out.group_names.emplace_back();
+                out.pooled_group = rest;
+            }
+            group_of_key[k] = rest;
+        }
     }
+    const size_t n_groups = out.group_names.size();
+    out.group_of.resize(n);
+    out.group_sizes.assign(n_groups, 0);
+    for (size_t i = 0; i < n; ++i) out.group_sizes[out.group_of[i] = group_of_key[key_of[i]]]++;
+
+    // 2. 计数排序：各组成员连续存放
+    std::vector<size_t> offset(n_groups + 1, 0), members(n);
+    for (size_t g = 0; g < n_groups; ++g) offset[g + 1] = offset[g] + out.group_sizes[g];
+    std::vector<size_t> fill(offset.begin(), offset.end() - 1);
+    for (size_t i = 0; i < n; ++i) members[fill[out.group_of[i]]++] = i;
+
+    // 3. 线程预算只有一份，不嵌套线程池：按数据量占比至少分得 2 个线程的大组逐个运行、组内用满全部线程；
+    //    其余小组之间并行、组内单线程，按大小降序调度（最长处理时间优先）
+    std::vector<uint32_t> order(n_groups);
+    for (uint32_t g = 0; g < n_groups; ++g) order[g] = g;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return out.group_sizes[a] != out.group_sizes[b] ? out.group_sizes[a] > out.group_sizes[b] : a < b;
+    });
+    const unsigned threads = default_thread_count();
+    out.scores.assign(n, 0.5);
+    out.group_flagged.assign(n_groups, 0);
+    out.group_thresholds.assign(n_groups, 1.0);
+    std::vector<std::vector<size_t>> flagged(n_groups);
+    auto run_group = [&](uint32_t g, unsigned inner) {
+        const size_t size = out.group_sizes[g];
+        if (size < 2) return;
+        std::vector<float> rows(size * dim);
+        for (size_t j = 0; j < size; ++j) std::copy_n(features.row(members[offset[g] + j]), dim, rows.data() + j * dim);
+        IsolationForest forest;
+        forest.fit(rows.data(), size, dim, inner);
+        std::vector<double> s = forest.score(rows.data(), size, inner);
+        for (size_t j = 0; j < size; ++j) out.scores[members[offset[g] + j]] = s[j];
+        std::vector<double> work = s;
+        const double threshold = select_quantiles(work, {1.0 - contamination})[0];
+        out.group_thresholds[g] = threshold;
+        for (size_t j = 0; j < size; ++j) {
+            if (s[j] >= threshold && s[j] > 0.5) flagged[g].push_back(members[offset[g] + j]);
+        }
+        out.group_flagged[g] = flagged[g].size();
+    };
+    size_t n_large = 0;
+    while (n_large < n_groups && out.group_sizes[order[n_large]] * threads >= 2 * n) run_group(order[n_large++], threads);
+    parallel_for(n_groups - n_large, [&](size_t slot) { run_group(order[n_large + slot], 1); }, threads);
 
-    // 按金额降序排序
-    std::sort(indexed_amounts.begin(), indexed_amounts.end(), [](const auto& a, const auto& b) {
-        return a.first > b.first;
+    // 4. 合并：按组内得分降序，同分按记录下标
+    for (const auto& f : flagged) out.indices.insert(out.indices.end(), f.begin(), f.end());
+    std::sort(out.indices.begin(), out.indices.end(), [&](size_t a, size_t b) {
+        return out.scores[a] != out.scores[b] ? out.scores[a] > out.scores[b] : a < b;
     });
+    return out;
+}
+
+std::vector<SeasonalAnomaly> AnomalyDetector::detect_seasonal(const std::vector<Record>& records, const std::vector<double>& daily,
+                                                              int first_day, double z_threshold) {
+    std::vector<SeasonalAnomaly> out;
+    const size_t n = daily.size();
+    // 周季节有足够多的周期，用局部 LOESS（约一个季度的周数）让周内形状随时间缓慢变化；
+    // 年季节通常只有几个完整周期，局部线性的子序列平滑会把端点处的尖峰吸收进季节项，故只对年周期用 periodic
+    StlOptions options;
+    options.seasonal_window = 13;
+    options.period_windows[365] = 0;
+    StlDecomposition d = mstl_decompose(daily, {7, 365}, options);
+    if (d.periods.empty()) return out;
 
-    // 取前 num_anomalies 个作为异常点
-    for (size_t i = 0; i < num_anomalies; ++i) {
-        anomalies_indices.push_back(indexed_amounts[i].second);
+    // 残差的中位数 / MAD
+    std::vector<double> work = d.residual;
+    const double med = select_quantiles(work, {0.5})[0];
+    for (size_t i = 0; i < n; ++i) work[i] = std::abs(d.residual[i] - med);
+    const double mad = 1.4826 * select_quantiles(work, {0.5})[0];
+    if (mad <= 1e-9) return out;
+    std::vector<int> slot(n, -1);
+    for (size_t i = 0; i < n; ++i) {
+        const double z = (d.residual[i] - med) / mad;
+        if (z <= z_threshold) continue;
+        slot[i] = static_cast<int>(out.size());
+        SeasonalAnomaly a;
+        a.day = first_day + static_cast<int>(i);
+        a.total = daily[i];
+        a.residual = d.residual[i];
+        a.expected = daily[i] - a.residual;
+        a.z = z;
+        out.push_back(std::move(a));
     }
 
-    // 也可以考虑金额最小的作为异常，或者结合均值和标准差
-    // 例如：金额小于 (均值 - 2*标准差) 的也认为是异常
-    // 这里为了简化，只取最大值作为异常
+    // 归因：一次遍历收集异常日的记录，按金额降序取到覆盖超额部分为止
+    for (size_t r = 0; r < records.size(); ++r) {
+        if (!valid_date(records[r].time_tm)) continue;
+        const long i = day_index(records[r].time_tm) - first_day;
+        if (i >= 0 && static_cast<size_t>(i) < n && slot[i] >= 0) out[slot[i]].records.push_back(r);
+    }
+    for (auto& a : out) {
+        std::sort(a.records.begin(), a.records.end(), [&](size_t x, size_t y) {
+            return records[x].amount != records[y].amount ? records[x].amount > records[y].amount : x < y;
+        });
+        double covered = 0.0;
+        size_t keep = 0;
+        while (keep < a.records.size() && covered < a.residual) covered += records[a.records[keep++]].amount;
+        a.records.resize(keep);
+    }
+    std::sort(out.begin(), out.end(), [](const SeasonalAnomaly& a, const SeasonalAnomaly& b) {
+        return a.z != b.z ? a.z > b.z : a.day < b.day;
+    });
+    return out;
+}
 
+std::vector<size_t> AnomalyDetector::detect_lof(const FeatureMatrix& features, double contamination, size_t k,
+                                                std::vector<double>* scores) {
+    std::vector<size_t> anomalies_indices;
+    if (scores) scores->clear();
+    if (features.rows == 0 || contamination <= 0 || contamination >= 1) {
+        return anomalies_indices;
+    }
+    std::vector<double> s = local_outlier_factor(features.data(), features.rows, features.dim, k);
+    std::vector<double> work = s;
+    const double threshold = select_quantiles(work, {1.0 - contamination})[0];
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] >= threshold && s[i] > LOF_THRESHOLD) anomalies_indices.push_back(i);
+    }
+    std::sort(anomalies_indices.begin(), anomalies_indices.end(), [&](size_t a, size_t b) {
+        return s[a] != s[b] ? s[a] > s[b] : a < b;
+    });
+    if (scores) *scores = std::move(s);
     return anomalies_indices;
 }
-
-
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <vector>
 #include <numeric>
+#include <functional>
 
 
 // Helper function to generate combinations
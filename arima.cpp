@@ -0,0 +1,188 @@
+#include "include/arima.h"
+#include "include/optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// 无约束参数 -> 平稳 AR 系数：tanh 得到偏自相关，再按 Durbin-Levinson 递推
+static void pacf_to_ar(const double* u, int k, double* out) {
+    std::vector<double> prev(k);
+    for (int j = 0; j < k; ++j) {
+        const double r = std::tanh(u[j]);
+        for (int i = 0; i < j; ++i) prev[i] = out[i];
+        for (int i = 0; i < j; ++i) out[i] = prev[i] - r * prev[j - 1 - i];
+        out[j] = r;
+    }
+}
+
+// 多项式乘积：(1 + sign*sum a_i B^i)(1 + sign*sum b_j B^{s j})，返回 1 之后的系数（已乘回 sign）
+static std::vector<double> expand(const std::vector<double>& a, const std::vector<double>& b, int s, double sign) {
+    std::vector<double> pa(a.size() + 1, 0.0), pb(b.size() * s + 1, 0.0);
+    pa[0] = pb[0] = 1.0;
+    for (size_t i = 0; i < a.size(); ++i) pa[i + 1] = sign * a[i];
+    for (size_t j = 0; j < b.size(); ++j) pb[(j + 1) * s] = sign * b[j];
+    std::vector<double> prod(pa.size() + pb.size() - 1, 0.0);
+    for (size_t i = 0; i < pa.size(); ++i)
+        for (size_t j = 0; j < pb.size(); ++j) prod[i + j] += pa[i] * pb[j];
+    std::vector<double> out(prod.size() - 1);
+    for (size_t k = 1; k < prod.size(); ++k) out[k - 1] = sign * prod[k];
+    return out;
+}
+
+static std::vector<double> difference(std::vector<double> x, int lag, int times) {
+    for (int t = 0; t < times; ++t) {
+        if (x.size() <= static_cast<size_t>(lag)) return {};
+        for (size_t i = x.size() - 1; i >= static_cast<size_t>(lag); --i) x[i] -= x[i - lag];
+        x.erase(x.begin(), x.begin() + lag);
+    }
+    return x;
+}
+
+static double std_dev(const std::vector<double>& x) {
+    if (x.size() < 2) return INFINITY;
+    const double m = std::accumulate(x.begin(), x.end(), 0.0) / x.size();
+    double s = 0.0;
+    for (double v : x) s += (v - m) * (v - m);
+    return std::sqrt(s / (x.size() - 1));
+}
+
+bool Arima::fit(const std::vector<double>& data, const ArimaOrder& order) {
+    fitted = false;
+    ord = order;
+    if (ord.P + ord.D + ord.Q == 0) ord.s = 1;
+    std::vector<double> w = difference(difference(data, 1, ord.d), ord.s, ord.D);
+    const int k = ord.p + ord.q + ord.P + ord.Q;
+    if (w.size() < static_cast<size_t>(k + 3)) return false;
+    mean = 0.0;
+    if (ord.d + ord.D == 0) {
+        mean = std::accumulate(w.begin(), w.end(), 0.0) / w.size();
+        for (double& v : w) v -= mean;
+    }
+
+    KalmanWorkspace ws;
+    ws.resize(ord.p + ord.s * ord.P, ord.q + ord.s * ord.Q);
+    auto unpack = [&](const std::vector<double>& u) {
+        ar.assign(ord.p, 0.0); ma.assign(ord.q, 0.0); sar.assign(ord.P, 0.0); sma.assign(ord.Q, 0.0);
+        const double* x = u.data();
+        pacf_to_ar(x, ord.p, ar.data()); x += ord.p;
+        pacf_to_ar(x, ord.q, ma.data()); x += ord.q;
+        pacf_to_ar(x, ord.P, sar.data()); x += ord.P;
+        pacf_to_ar(x, ord.Q, sma.data());
+        // MA 取负号：1 + sum theta_j B^j = 1 - sum c_j B^j，与平稳 AR 多项式同根，因而可逆
+        for (double& c : ma) c = -c;
+        for (double& c : sma) c = -c;
+        phi_full = expand(ar, sar, ord.s, -1.0);
+        theta_full = expand(ma, sma, ord.s, 1.0);
+    };
+    auto objective = [&](const std::vector<double>& u) {
+        unpack(u);
+        return ws.filter(w.data(), w.size(), phi_full.data(), theta_full.data()).neg2_loglik();
+    };
+    std::vector<double> u(k, 0.1);
+    if (k > 0) u = nelder_mead_bounded(objective, u, std::vector<double>(k, -3.0), std::vector<double>(k, 3.0), 200 * k).x;
+    unpack(u);
+
+    std::vector<double> v(w.size());
+    KalmanWorkspace::Result res = ws.filter(w.data(), w.size(), phi_full.data(), theta_full.data(), v.data());
+    if (!std::isfinite(res.sum_sq)) return false;
+    sigma2 = res.sigma2();
+    neg2_loglik = res.neg2_loglik();
+    n_eff = res.n;
+    history = data;
+    innovations.assign(data.size() - w.size(), 0.0);
+    innovations.insert(innovations.end(), v.begin(), v.end());
+    fitted = true;
+    return true;
+}
+
+bool Arima::fit_auto(const std::vector<double>& data, int season) {
+    fitted = false;
+    if (data.size() < 8) return false;
+    // 差分阶数：先季节后普通，差分后波动下降才保留
+    int D = 0, d = 0;
+    std::vector<double> base = data;
+    if (season > 1 && data.size() >= static_cast<size_t>(2 * season + 4)) {
+        std::vector<double> sd = difference(base, season, 1);
+        if (std_dev(sd) < std_dev(base)) { D = 1; base = sd; }
+    }
+    if (std_dev(difference(base, 1, 1)) < std_dev(base)) d = 1;
+
+    std::vector<ArimaOrder> orders;
+    for (auto [p, q] : {std::pair{0, 0}, {1, 0}, {0, 1}, {1, 1}, {2, 0}}) {
+        orders.push_back({p, d, q, 0, D, 0, season});
+        if (D == 1 || data.size() >= static_cast<size_t>(3 * season)) {
+            orders.push_back({p, d, q, 0, D, 1, season});
+            orders.push_back({p, d, q, 1, D, 0, season});
+        }
+    }
+    Arima best;
+    for (const auto& o : orders) {
+        Arima cand;
+        if (!cand.fit(data, o)) continue;
+        if (!best.fitted || cand.aicc() < best.aicc()) best = std::move(cand);
+    }
+    if (!best.fitted) return false;
+    *this = std::move(best);
+    return true;
+}
+
+double Arima::aicc() const {
+    const double k = n_params() + 1; // 含 sigma^2
+    const double aic = neg2_loglik + 2.0 * k;
+    return n_eff > k + 1 ? aic + 2.0 * k * (k + 1) / (n_eff - k - 1) : INFINITY;
+}
+
+Arima::Forecast Arima::forecast(int steps) const {
+    Forecast out;
+    if (!fitted || steps <= 0) return out;
+    // 差分并回 AR 多项式：phi*(B) = phi(B)(1-B)^d(1-B^s)^D，写成 x_t = sum phi*_i x_{t-i} + ...
+    std::vector<double> poly(phi_full.size() + 1, 0.0);
+    poly[0] = 1.0;
+    for (size_t i = 0; i < phi_full.size(); ++i) poly[i + 1] = -phi_full[i];
+    auto multiply_diff = [&](int lag) {
+        std::vector<double> next(poly.size() + lag, 0.0);
+        for (size_t i = 0; i < poly.size(); ++i) { next[i] += poly[i]; next[i + lag] -= poly[i]; }
+        poly.swap(next);
+    };
+    for (int i = 0; i < ord.d; ++i) multiply_diff(1);
+    for (int i = 0; i < ord.D; ++i) multiply_diff(ord.s);
+    const size_t np = poly.size() - 1, nq = theta_full.size();
+
+    std::vector<double> x(history), e(innovations);
+    for (double& v : x) v -= mean;
+    for (int h = 1; h <= steps; ++h) {
+        const size_t t = x.size();
+        double pred = 0.0;
+        for (size_t i = 1; i <= np && i <= t; ++i) pred -= poly[i] * x[t - i];
+        for (size_t j = 1; j <= nq && j <= t; ++j) pred += theta_full[j - 1] * e[t - j];
+        x.push_back(pred);
+        e.push_back(0.0); // 未来扰动期望为 0
+        out.mean.push_back(pred + mean);
+    }
+    // psi 权重：psi_0 = 1，psi_j = theta_j - sum_{i=1..j} poly_i psi_{j-i}
+    std::vector<double> psi(steps, 0.0);
+    double acc = 0.0;
+    for (int j = 0; j < steps; ++j) {
+        psi[j] = j == 0 ? 1.0 : (static_cast<size_t>(j) <= nq ? theta_full[j - 1] : 0.0);
+        for (int i = 1; i <= j && static_cast<size_t>(i) <= np; ++i) psi[j] -= poly[i] * psi[j - i];
+        acc += psi[j] * psi[j];
+        out.std_err.push_back(std::sqrt(sigma2 * acc));
+    }
+    return out;
+}
+
+nlohmann::json Arima::to_json() const {
+    nlohmann::json j;
+    j["order"] = {ord.p, ord.d, ord.q};
+    j["seasonal_order"] = {ord.P, ord.D, ord.Q, ord.s};
+    j["ar"] = ar;
+    j["ma"] = ma;
+    j["seasonal_ar"] = sar;
+    j["seasonal_ma"] = sma;
+    j["mean"] = mean;
+    j["sigma2"] = sigma2;
+    j["log_likelihood"] = -0.5 * neg2_loglik;
+    j["aicc"] = aicc();
+    j["observations"] = n_eff;
+    return j;
+}
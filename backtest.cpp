@@ -0,0 +1,227 @@
+#include "include/backtest.h"
+#include "include/parallel.h"
+#include "include/arima.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+static void smoothing_blend(double alpha, double phi1, double weight, const double* y, size_t n, int first_month,
+                            int horizon, std::vector<double>& mean, std::vector<double>& half_width) {
+    double smooth = y[n - 1];
+    for (size_t i = n - 1; i > 0; --i) smooth = alpha * y[i] + (1 - alpha) * smooth;
+    const double next = n >= 2 ? smooth + 0.5 * (y[n - 1] - y[n - 2]) : smooth;
+    const double hist_mean = std::accumulate(y, y + n, 0.0) / n;
+    double sd = 0.0;
+    for (size_t i = 0; i < n; ++i) sd += (y[i] - hist_mean) * (y[i] - hist_mean);
+    sd = n > 1 ? std::sqrt(sd / (n - 1)) : 0.0;
+    for (int h = 1; h <= horizon; ++h) {
+        double pred = smooth;
+        if (h >= 2) {
+            // 目标月的日历月份与历史同月均值
+            const int target_moy = (first_month + static_cast<int>(n) + h - 1) % 12;
+            double same_sum = 0.0;
+            int same_count = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if ((first_month + static_cast<int>(i)) % 12 == target_moy) { same_sum += y[i]; same_count++; }
+            }
+            double seasonal_index = 1.0;
+            if (same_count > 0 && hist_mean > 1e-9) seasonal_index = (same_sum / same_count) / hist_mean;
+            pred = next * seasonal_index;
+            if (n >= 2) pred = weight * pred + (1 - weight) * (hist_mean + phi1 * (y[n - 1] - hist_mean));
+        }
+        mean.push_back(pred);
+        half_width.push_back(sd);
+    }
+}
+
+ForecastCandidate smoothing_blend_candidate(double alpha, double phi1, double weight) {
+    return {"smoothing_blend", {{"alpha", alpha}, {"phi1", phi1}, {"weight", weight}},
+            [=](const double* y, size_t n, int first_month, int horizon, std::vector<double>& mean, std::vector<double>& half) {
+                smoothing_blend(alpha, phi1, weight, y, n, first_month, horizon, mean, half);
+            }};
+}
+
+ForecastCandidate ar_candidate(int order) {
+    nlohmann::json params = {{"order", order < 0 ? nlohmann::json("bic") : nlohmann::json(order)}};
+    return {"ar", params, [=](const double* y, size_t n, int, int horizon, std::vector<double>& mean, std::vector<double>& half) {
+        TimeSeriesForecaster model;
+        std::vector<double> data(y, y + n);
+        if (order < 0) model.fit_auto(data, std::min<int>(6, n / 2), TimeSeriesForecaster::Criterion::BIC);
+        else model.fit(data, std::min<int>(order, n - 1));
+        mean = model.predict(horizon);
+        // psi 权重：h 步预测误差方差 = sigma2 * sum_{j<h} psi_j^2
+        const auto& phi = model.coefficients();
+        std::vector<double> psi(horizon, 0.0);
+        double acc = 0.0;
+        for (int j = 0; j < horizon; ++j) {
+            psi[j] = j == 0 ? 1.0 : 0.0;
+            for (int i = 1; i <= std::min<int>(j, phi.size()); ++i) psi[j] += phi[i - 1] * psi[j - i];
+            acc += psi[j] * psi[j];
+            half.push_back(1.96 * std::sqrt(std::max(0.0, model.residual_variance()) * acc));
+        }
+    }};
+}
+
+static const char* seasonality_labels[] = {"none", "additive", "multiplicative"};
+
+static ForecastCandidate make_holt_winters(bool auto_select, HoltWinters::Seasonality seasonality, const char* label) {
+    return {"holt_winters", {{"seasonality", label}},
+            [=](const double* y, size_t n, int, int horizon, std::vector<double>& mean, std::vector<double>& half) {
+        HoltWinters model;
+        std::vector<double> data(y, y + n);
+        if (auto_select) model.fit_auto(data, 12);
+        else model.fit(data, 12, seasonality);
+        for (int h = 1; h <= horizon; ++h) {
+            mean.push_back(model.forecast_at(h));
+            // 近似：误差方差随步长线性增长
+            half.push_back(1.96 * model.residual_std() * std::sqrt(static_cast<double>(h)));
+        }
+    }};
+}
+
+ForecastCandidate holt_winters_candidate() {
+    return make_holt_winters(true, HoltWinters::Seasonality::Additive, "auto");
+}
+
+ForecastCandidate holt_winters_candidate(HoltWinters::Seasonality seasonality) {
+    return make_holt_winters(false, seasonality, seasonality_labels[static_cast<int>(seasonality)]);
+}
+
+bool fit_holt_winters_candidate(const ForecastCandidate& candidate, const std::vector<double>& history, HoltWinters& model) {
+    if (candidate.name != "holt_winters" || history.empty()) return false;
+    const std::string label = candidate.params.value("seasonality", "auto");
+    for (int k = 0; k < 3; ++k) {
+        if (label == seasonality_labels[k]) {
+            model.fit(history, 12, static_cast<HoltWinters::Seasonality>(k));
+            return true;
+        }
+    }
+    model.fit_auto(history, 12);
+    return true;
+}
+
+ForecastCandidate arima_candidate() {
+    return {"arima", {{"order", "auto"}}, [](const double* y, size_t n, int, int horizon, std::vector<double>& mean, std::vector<double>& half) {
+        Arima model;
+        if (model.fit_auto(std::vector<double>(y, y + n), 12)) {
+            Arima::Forecast f = model.forecast(horizon);
+            mean = f.mean;
+            for (double se : f.std_err) half.push_back(1.96 * se);
+            return;
+        }
+        mean.assign(horizon, y[n - 1]);
+        half.assign(horizon, 0.0);
+    }};
+}
+
+std::vector<ForecastCandidate> default_candidates() {
+    // 原 complex_analysis 中的月度预测（Holt-Winters 之前的 monthly_predict）
+    ForecastCandidate legacy = smoothing_blend_candidate(0.7, 0.5, 0.5);
+    legacy.name = "legacy_blend";
+    return {legacy, ar_candidate(-1), holt_winters_candidate()};
+}
+
+namespace {
+struct Accumulator {
+    std::vector<double> ape, sape;
+    std::vector<size_t> n_ape, n_sape, covered, count;
+    double fit_ms = 0.0;
+    explicit Accumulator(int horizon = 0)
+        : ape(horizon, 0.0), sape(horizon, 0.0), n_ape(horizon, 0), n_sape(horizon, 0), covered(horizon, 0), count(horizon, 0) {}
+};
+}
+
+std::vector<CandidateScore> run_backtest(const SeriesMatrix& series, int first_month,
+                                         const std::vector<ForecastCandidate>& candidates,
+                                         const BacktestOptions& options) {
+    const size_t n_cand = candidates.size();
+    const int H = std::max(options.horizon, 1);
+    std::vector<Accumulator> acc(series.rows() * n_cand, Accumulator(H));
+    const size_t length = series.length;
+    const size_t min_train = std::max<size_t>(options.min_train, 2);
+    // 起点 t：训练 [0, t)，至少要能评估第 1 步
+    size_t first_origin = min_train;
+    if (length > min_train && length - min_train > options.max_origins) first_origin = length - options.max_origins;
+
+    parallel_for(acc.size(), [&](size_t task) {
+        const size_t row = task / n_cand;
+        const ForecastCandidate& cand = candidates[task % n_cand];
+        Accumulator& a = acc[task];
+        const double* y = series.row(row);
+        std::vector<double> mean, half;
+        for (size_t t = first_origin; t < length; ++t) {
+            mean.clear();
+            half.clear();
+            auto start = std::chrono::steady_clock::now();
+            cand.forecast(y, t, first_month, H, mean, half);
+            a.fit_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            for (int h = 0; h < H && t + h < length && h < static_cast<int>(mean.size()); ++h) {
+                const double actual = y[t + h], pred = mean[h];
+                if (std::abs(actual) > 1e-9) { a.ape[h] += std::abs(pred - actual) / std::abs(actual); a.n_ape[h]++; }
+                const double denom = std::abs(pred) + std::abs(actual);
+                if (denom > 1e-9) { a.sape[h] += 2.0 * std::abs(pred - actual) / denom; a.n_sape[h]++; }
+                if (std::abs(actual - pred) <= half[h]) a.covered[h]++;
+                a.count[h]++;
+            }
+        }
+    }, options.threads);
+
+    // 固定顺序归并
+    std::vector<CandidateScore> scores(n_cand);
+    for (size_t c = 0; c < n_cand; ++c) {
+        CandidateScore& s = scores[c];
+        s.name = candidates[c].name;
+        Accumulator total(H);
+        for (size_t row = 0; row < series.rows(); ++row) {
+            const Accumulator& a = acc[row * n_cand + c];
+            for (int h = 0; h < H; ++h) {
+                total.ape[h] += a.ape[h]; total.n_ape[h] += a.n_ape[h];
+                total.sape[h] += a.sape[h]; total.n_sape[h] += a.n_sape[h];
+                total.covered[h] += a.covered[h]; total.count[h] += a.count[h];
+            }
+            total.fit_ms += a.fit_ms;
+            if (a.count[0] > 0) s.series++;
+        }
+        for (int h = 0; h < H; ++h) {
+            HorizonScore hs;
+            hs.mape = total.n_ape[h] ? 100.0 * total.ape[h] / total.n_ape[h] : 0.0;
+            hs.smape = total.n_sape[h] ? 100.0 * total.sape[h] / total.n_sape[h] : 0.0;
+            hs.coverage = total.count[h] ? static_cast<double>(total.covered[h]) / total.count[h] : 0.0;
+            hs.forecasts = total.count[h];
+            s.horizons.push_back(hs);
+        }
+        s.fit_ms_total = total.fit_ms;
+        s.fit_ms_per_series = s.series ? total.fit_ms / s.series : 0.0;
+    }
+    return scores;
+}
+
+nlohmann::json backtest_to_json(const std::vector<CandidateScore>& scores, const BacktestOptions& options) {
+    nlohmann::json j;
+    j["min_train"] = options.min_train;
+    j["horizon"] = options.horizon;
+    j["max_origins"] = options.max_origins;
+    std::string best;
+    double best_smape = 0.0;
+    for (const auto& s : scores) {
+        nlohmann::json c;
+        for (size_t h = 0; h < s.horizons.size(); ++h) {
+            const auto& hs = s.horizons[h];
+            c["h" + std::to_string(h + 1)] = {
+                {"mape", hs.mape}, {"smape", hs.smape}, {"coverage", hs.coverage}, {"forecasts", hs.forecasts}
+            };
+        }
+        c["series"] = s.series;
+        c["fit_ms_total"] = s.fit_ms_total;
+        c["fit_ms_per_series"] = s.fit_ms_per_series;
+        j["candidates"][s.name] = c;
+        // 以最后一步（下月）sMAPE 选最优
+        if (!s.horizons.empty() && s.horizons.back().forecasts > 0 && (best.empty() || s.horizons.back().smape < best_smape)) {
+            best = s.name;
+            best_smape = s.horizons.back().smape;
+        }
+    }
+    j["best_by_smape"] = best;
+    return j;
+}
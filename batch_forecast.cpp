@@ -0,0 +1,98 @@
+#include "include/forecast_analyzer.h"
+#include "include/parallel.h"
+#include "include/date_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <unordered_map>
+
+GroupedSeries build_grouped_series(const std::vector<Record>& records,
+                                   const std::map<std::string, TypeStats>& type_stats,
+                                   const std::map<std::string, CountryStats>& country_stats,
+                                   const SpaceSaving& product_spend,
+                                   const std::vector<double>* weights,
+                                   size_t top_products) {
+    GroupedSeries out;
+    // 1. 月份轴：与 forecast_analysis 一致，排除未结束的当前月；
+    // 只取日期有效的记录（与下面的填充一致），解析失败的日期不会把轴拉回到 1899 年
+    time_t t_now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    struct tm tm_now;
+    localtime_r(&t_now, &tm_now);
+    out.current_month = (tm_now.tm_year + 1900) * 12 + tm_now.tm_mon;
+    int first = -1, last = -1;
+    for (const auto& r : records) {
+        if (!valid_date(r.time_tm)) continue;
+        const int idx = (r.time_tm.tm_year + 1900) * 12 + r.time_tm.tm_mon;
+        if (idx == out.current_month) continue;
+        if (first < 0 || idx < first) first = idx;
+        if (idx > last) last = idx;
+    }
+    if (first < 0) return out;
+    out.first_month = first;
+    const size_t length = last - first + 1;
+
+    // 2. 行：总额、全部类别、全部国家、消费额前 top_products 的商品
+    // 商品取解析时累计的 Space-Saving 消费额摘要，不对全部商品排序
+    const std::vector<SpaceSaving::Entry> ranked = product_spend.top(top_products);
+
+    std::unordered_map<std::string, size_t> rows[3];
+    std::vector<std::string> names = {"all"};
+    out.groups = {"total"};
+    auto add_row = [&](int g, const char* group, const std::string& key) {
+        rows[g].emplace(key, names.size());
+        names.push_back(key);
+        out.groups.push_back(group);
+    };
+    for (const auto& [key, _] : type_stats) add_row(0, "category", key);
+    for (const auto& e : ranked) add_row(1, "product", e.key);
+    for (const auto& [key, _] : country_stats) add_row(2, "country", key);
+    out.matrix = SeriesMatrix(std::move(names), length);
+
+    // 3. 一次遍历填充矩阵
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& r = records[i];
+        if (!valid_date(r.time_tm)) continue;
+        int idx = (r.time_tm.tm_year + 1900) * 12 + r.time_tm.tm_mon;
+        if (idx < first || idx > last) continue;
+        const size_t col = idx - first;
+        const double amount = weights ? (*weights)[i] * r.amount : r.amount;
+        out.matrix.row(0)[col] += amount;
+        const std::string* keys[3] = {&r.type, &r.product_name, &r.origin_country};
+        for (int g = 0; g < 3; ++g) {
+            auto it = rows[g].find(*keys[g]);
+            if (it != rows[g].end()) out.matrix.row(it->second)[col] += amount;
+        }
+    }
+    return out;
+}
+
+void batch_forecast_analysis(const GroupedSeries& series, AnalysisResult& result) {
+    const SeriesMatrix& matrix = series.matrix;
+    if (matrix.length == 0) return;
+    const int last = series.first_month + static_cast<int>(matrix.length) - 1;
+
+    // 并行拟合，递推到下一个自然月
+    const unsigned threads = default_thread_count();
+    const int max_order = std::min<int>(6, matrix.length / 2);
+    auto models = TimeSeriesForecaster::fit_batch(matrix, max_order, TimeSeriesForecaster::Criterion::BIC, threads);
+    const int target = series.current_month + 1;
+    const int steps = std::clamp(target - last, 1, 24);
+
+    nlohmann::json out;
+    out["month"] = format_month(target);
+    out["history"] = {{"from", format_month(series.first_month)}, {"to", format_month(last)}, {"months", matrix.length}};
+    out["series_count"] = matrix.rows();
+    out["threads"] = threads;
+    for (size_t i = 0; i < matrix.rows(); ++i) {
+        const auto& model = models[i];
+        std::vector<double> path = model.predict(steps);
+        out[series.groups[i]][matrix.names[i]] = {
+            {"next_month", path.empty() ? 0.0 : std::max(0.0, path.back())},
+            {"last_month", matrix.row(i)[matrix.length - 1]},
+            {"ar_order", model.order()},
+            {"residual_std", std::sqrt(std::max(0.0, model.residual_variance()))}
+        };
+    }
+    result.extra_json["forecasts"] = std::move(out);
+}
@@ -0,0 +1,60 @@
+#include "include/bootstrap.h"
+#include "include/counter_rng.h"
+#include "include/parallel.h"
+#include "include/quantile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+std::string QuantileBands::label(double p) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "q%g", p * 100.0);
+    return buf;
+}
+
+nlohmann::json QuantileBands::values_at(size_t h, double shift, double scale) const {
+    nlohmann::json j = nlohmann::json::object();
+    for (size_t k = 0; k < probs.size(); ++k) j[label(probs[k])] = std::max(0.0, (bands[k][h] + shift) * scale);
+    return j;
+}
+
+QuantileBands bootstrap_bands(const HoltWinters& model, const std::vector<double>& residuals,
+                              int horizon, const BootstrapOptions& options) {
+    QuantileBands out;
+    const size_t n = residuals.size();
+    if (!model.is_fitted() || n < 2 || horizon <= 0 || options.paths == 0) return out;
+    const size_t H = horizon;
+    const size_t block = std::clamp<size_t>(options.block ? options.block
+                                            : static_cast<size_t>(std::lround(std::cbrt(static_cast<double>(n)))), 1, n);
+    const size_t starts = n - block + 1;
+
+    // paths x H 行优先；每 64 条路径一个任务，任务内复用同一个模型副本
+    std::vector<double> sims(options.paths * H);
+    const size_t chunk = 64, n_chunks = (options.paths + chunk - 1) / chunk;
+    parallel_for(n_chunks, [&](size_t c) {
+        HoltWinters sim;
+        for (size_t path = c * chunk; path < std::min(options.paths, (c + 1) * chunk); ++path) {
+            sim = model;
+            double* row = sims.data() + path * H;
+            for (size_t h = 0; h < H; ++h) {
+                const size_t start = counter_index(options.seed, path, h / block, starts);
+                const double y = sim.forecast_at(1) + residuals[start + h % block];
+                sim.update(y);
+                row[h] = y;
+            }
+        }
+    }, options.threads);
+
+    out.probs = options.quantiles;
+    out.paths = options.paths;
+    out.block = block;
+    out.point = model.forecast(horizon);
+    out.bands.assign(out.probs.size(), std::vector<double>(H, 0.0));
+    parallel_for(H, [&](size_t h) {
+        std::vector<double> column(options.paths);
+        for (size_t p = 0; p < options.paths; ++p) column[p] = sims[p * H + h];
+        std::vector<double> q = select_quantiles(column, out.probs);
+        for (size_t k = 0; k < q.size(); ++k) out.bands[k][h] = q[k];
+    }, options.threads);
+    return out;
+}
@@ -0,0 +1,40 @@
+#include "include/calendar.h"
+#include "include/date_util.h"
+
+void DenseCalendar::build(const std::vector<Record>& records, const std::vector<double>* weights) {
+    months.clear();
+    for (size_t i = 0; i < records.size(); ++i) add(records[i].time_tm, weights ? (*weights)[i] * records[i].amount : records[i].amount);
+}
+
+void DenseCalendar::add(const tm& date, double amount) {
+    if (!valid_date(date) || date.tm_mday > 31) return;
+    const int idx = (date.tm_year + 1900) * 12 + date.tm_mon;
+    if (months.empty()) {
+        first = idx;
+        months.resize(1);
+    } else if (idx < first) {
+        months.insert(months.begin(), first - idx, Month{});
+        first = idx;
+    } else if (idx > last_month()) {
+        months.resize(idx - first + 1);
+    }
+    Month& m = months[idx - first];
+    m.days[date.tm_mday - 1] += amount;
+    m.total += amount;
+}
+
+double DenseCalendar::day(int month_index, int d) const {
+    if (!contains(month_index) || d < 1 || d > 31) return 0.0;
+    return months[month_index - first].days[d - 1];
+}
+
+double DenseCalendar::month_total(int month_index) const {
+    return contains(month_index) ? months[month_index - first].total : 0.0;
+}
+
+int DenseCalendar::days_in_month(int month_index) {
+    static const int days[12] = {31,28,31,30,31,30,31,31,30,31,30,31};
+    const int y = month_index / 12, m = month_index % 12 + 1;
+    if (m == 2 && ((y%4==0&&y%100!=0)||y%400==0)) return 29;
+    return days[m-1];
+}
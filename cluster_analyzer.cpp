@@ -1,98 +1,106 @@
 #include "include/cluster_analyzer.h"
-#include <random>
+#include <algorithm>
 #include <limits>
-#include <cmath>
 #include <numeric>
 
-// 计算两个记录之间的距离（这里简化为金额的欧氏距离）
-static double calculate_distance(const Record& r1, const Record& r2) {
-    return std::abs(r1.amount - r2.amount);
-}
-
-std::vector<ClusterInfo> ClusterAnalyzer::kmeans_cluster(const std::vector<Record>& records, int num_clusters) {
-    std::vector<ClusterInfo> clusters(num_clusters);
-    if (records.empty() || num_clusters <= 0) return clusters;
-
-    // 1. 初始化质心：随机选择 num_clusters 个记录作为初始质心
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(0, records.size() - 1);
-
-    std::vector<Record> centroids(num_clusters);
-    std::vector<int> assigned_cluster(records.size());
-
-    for (int i = 0; i < num_clusters; ++i) {
-        centroids[i] = records[distrib(gen)];
+namespace {
+
+// Ckmeans.1d.dp（Wang & Song 2011；Grønlund et al. 2017）
+// D[m][i] = min_j D[m-1][j-1] + SSE(j..i)，最优分割点 j 关于 i 单调不减，
+// 每层用分治在 O(n log n) 内求出整行，共 O(k·n·log n)；SSE 由前缀和 O(1) 得到。
+class Ckmeans {
+public:
+    Ckmeans(const std::vector<double>& sorted, int k) : x(sorted), n(sorted.size()), k(k) {
+        // 以中位数平移，减小前缀平方和的抵消误差
+        const double shift = n ? x[n / 2] : 0.0;
+        sum.assign(n + 1, 0.0);
+        sum_sq.assign(n + 1, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            const double v = x[i] - shift;
+            sum[i + 1] = sum[i] + v;
+            sum_sq[i + 1] = sum_sq[i] + v * v;
+        }
     }
 
-    bool changed = true;
-    int max_iterations = 100; // 防止无限循环
-    int iteration = 0;
-
-    while (changed && iteration < max_iterations) {
-        changed = false;
-        iteration++;
-
-        // 2. 分配阶段：将每个记录分配到最近的质心
-        for (size_t i = 0; i < records.size(); ++i) {
-            double min_dist = std::numeric_limits<double>::max();
-            int closest_cluster = -1;
-
-            for (int j = 0; j < num_clusters; ++j) {
-                double dist = calculate_distance(records[i], centroids[j]);
-                if (dist < min_dist) {
-                    min_dist = dist;
-                    closest_cluster = j;
-                }
-            }
-
-            if (closest_cluster != assigned_cluster[i]) {
-                assigned_cluster[i] = closest_cluster;
-                changed = true;
-            }
+    // 返回每个簇的起始下标（共 k 个，升序）
+    std::vector<size_t> solve() {
+        std::vector<double> prev(n), cur(n);
+        split.assign(k, std::vector<size_t>(n, 0));
+        for (size_t i = 0; i < n; ++i) prev[i] = sse(0, i);
+        for (int m = 1; m < k; ++m) {
+            // 第 m 层只对 i >= m 有定义（每簇至少一个点）
+            fill_row(m, prev, cur, m, n - 1, m, n - 1);
+            std::swap(prev, cur);
         }
+        std::vector<size_t> starts(k);
+        size_t end = n - 1;
+        for (int m = k - 1; m >= 0; --m) {
+            starts[m] = m == 0 ? 0 : split[m][end];
+            if (m > 0) end = starts[m] - 1;
+        }
+        return starts;
+    }
 
-        // 如果没有记录改变所属集群，则收敛
-        if (!changed) break;
+private:
+    const std::vector<double>& x;
+    size_t n;
+    int k;
+    std::vector<double> sum, sum_sq;
+    std::vector<std::vector<size_t>> split;
 
-        // 3. 更新阶段：重新计算每个集群的质心
-        std::vector<double> new_centroids_amount(num_clusters, 0.0);
-        std::vector<int> cluster_member_counts(num_clusters, 0);
+    double sse(size_t j, size_t i) const {
+        const double s = sum[i + 1] - sum[j], cnt = static_cast<double>(i - j + 1);
+        return std::max(0.0, sum_sq[i + 1] - sum_sq[j] - s * s / cnt);
+    }
 
-        for (int i = 0; i < num_clusters; ++i) {
-            clusters[i].member_indices.clear(); // 清空旧的成员
+    void fill_row(int m, const std::vector<double>& prev, std::vector<double>& cur,
+                  size_t lo, size_t hi, size_t opt_lo, size_t opt_hi) {
+        if (lo > hi) return;
+        const size_t mid = lo + (hi - lo) / 2;
+        double best = std::numeric_limits<double>::infinity();
+        size_t best_j = opt_lo;
+        for (size_t j = opt_lo; j <= std::min(mid, opt_hi); ++j) {
+            const double cost = prev[j - 1] + sse(j, mid);
+            if (cost < best) { best = cost; best_j = j; }
         }
+        cur[mid] = best;
+        split[m][mid] = best_j;
+        if (mid > lo) fill_row(m, prev, cur, lo, mid - 1, opt_lo, best_j);
+        fill_row(m, prev, cur, mid + 1, hi, best_j, opt_hi);
+    }
+};
 
-        for (size_t i = 0; i < records.size(); ++i) {
-            int cluster_idx = assigned_cluster[i];
-            if (cluster_idx != -1) {
-                new_centroids_amount[cluster_idx] += records[i].amount;
-                cluster_member_counts[cluster_idx]++;
-                clusters[cluster_idx].member_indices.push_back(i);
-            }
-        }
+} // namespace
 
-        for (int i = 0; i < num_clusters; ++i) {
-            if (cluster_member_counts[i] > 0) {
-                centroids[i].amount = new_centroids_amount[i] / cluster_member_counts[i];
-            } else {
-                // 如果某个集群为空，重新随机选择一个记录作为质心
-                centroids[i] = records[distrib(gen)];
-            }
-        }
-    }
+std::vector<ClusterInfo> ClusterAnalyzer::kmeans_cluster(const std::vector<Record>& records, int num_clusters) {
+    std::vector<ClusterInfo> clusters(std::max(num_clusters, 0));
+    if (records.empty() || num_clusters <= 0) return clusters;
 
-    // 填充最终的集群信息
-    for (int i = 0; i < num_clusters; ++i) {
-        clusters[i].cluster_total = 0.0;
-        for (size_t record_idx : clusters[i].member_indices) {
-            clusters[i].cluster_total += records[record_idx].amount;
+    // 1. 按金额排序一次（同额按下标，结果确定）
+    std::vector<size_t> order(records.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return records[a].amount != records[b].amount ? records[a].amount < records[b].amount : a < b;
+    });
+    std::vector<double> sorted(order.size());
+    for (size_t i = 0; i < order.size(); ++i) sorted[i] = records[order[i]].amount;
+
+    // 2. 精确最优一维划分；记录数少于簇数时多出的簇为空
+    const int k = static_cast<int>(std::min<size_t>(num_clusters, sorted.size()));
+    std::vector<size_t> starts = Ckmeans(sorted, k).solve();
+    starts.push_back(sorted.size());
+
+    // 3. 簇按质心从高到低编号：Cluster 1 为高额，依次递减
+    for (int c = 0; c < k; ++c) {
+        ClusterInfo& info = clusters[c];
+        const size_t begin = starts[k - 1 - c], end = starts[k - c];
+        for (size_t i = begin; i < end; ++i) {
+            info.member_indices.push_back(order[i]);
+            info.cluster_total += sorted[i];
         }
-        clusters[i].avg_amount = clusters[i].member_indices.empty() ? 0.0 : clusters[i].cluster_total / clusters[i].member_indices.size();
-        clusters[i].label = "Cluster " + std::to_string(i + 1);
+        std::sort(info.member_indices.begin(), info.member_indices.end());
+        info.avg_amount = info.member_indices.empty() ? 0.0 : info.cluster_total / info.member_indices.size();
     }
-
+    for (int i = 0; i < num_clusters; ++i) clusters[i].label = "Cluster " + std::to_string(i + 1);
     return clusters;
 }
-
-
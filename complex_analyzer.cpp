@@ -4,12 +4,18 @@
 #include <chrono>
 #include <array>
 #include "include/stats.h"
+#include "include/quantile.h"
+#include "include/rolling_window.h"
+#include "include/date_util.h"
+#include "include/simd_kernels.h"
+#include "include/feature_matrix.h"
 #include <iostream>
 #include <algorithm>
 #include <numeric>
 #include <set>
 
-AnalysisResult complex_analysis(const std::vector<Record>& records, const I18N& i18n) {
+AnalysisResult complex_analysis(const std::vector<Record>& records, const I18N& i18n, const std::string& forecast_state,
+                                const std::vector<double>* weights) {
     AnalysisResult result;
     result.lang = i18n.t("lang_code");
     // 生成时间
@@ -18,35 +24,100 @@ AnalysisResult complex_analysis(const std::vector<Record>& records, const I18N&
     strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&now));
     result.generated_time = buf;
     result.total_records = records.size();
-    // 金额统计
+    // 金额统计（向量化归约：和/平方和/极值一次遍历）
     std::vector<double> amounts;
+    amounts.reserve(records.size());
     for (const auto& r : records) amounts.push_back(r.amount);
-    result.total_amount = std::accumulate(amounts.begin(), amounts.end(), 0.0);
+    simd::Reduction amount_red = simd::reduce(amounts.data(), amounts.size());
+    result.total_amount = amount_red.sum;
     result.avg_amount = result.total_records ? result.total_amount / result.total_records : 0.0;
-    result.min_amount = amounts.empty() ? 0.0 : *std::min_element(amounts.begin(), amounts.end());
-    result.max_amount = amounts.empty() ? 0.0 : *std::max_element(amounts.begin(), amounts.end());
+    result.min_amount = amounts.empty() ? 0.0 : amount_red.min;
+    result.max_amount = amounts.empty() ? 0.0 : amount_red.max;
     if (!amounts.empty()) {
-        std::vector<double> sorted = amounts;
-        std::sort(sorted.begin(), sorted.end());
-        size_t n = sorted.size() / 2;
-        result.median_amount = (sorted.size() % 2 == 0) ? (sorted[n-1] + sorted[n]) / 2.0 : sorted[n];
-        double mean = result.avg_amount;
-        double var = 0.0;
-        for (auto v : amounts) var += (v - mean) * (v - mean);
-        result.stddev_amount = sorted.size() > 1 ? sqrt(var / (sorted.size() - 1)) : 0.0;
+        double ssd = simd::sum_sq_dev(amounts.data(), amounts.size(), result.avg_amount);
+        result.stddev_amount = amounts.size() > 1 ? sqrt(ssd / (amounts.size() - 1)) : 0.0;
+        std::vector<uint64_t> hist = simd::histogram(amounts.data(), amounts.size(), amount_red.min, amount_red.max, 20);
+        result.extra_json["amount_histogram"] = {{"min", amount_red.min}, {"max", amount_red.max}, {"counts", hist}};
+        // 进口/黑名单子集：位图驱动的掩码归约
+        auto summary = [](const simd::Reduction& r) {
+            return nlohmann::json{{"count", r.count}, {"total", r.sum}, {"avg", r.count ? r.sum / r.count : 0.0}};
+        };
+        simd::Bitmap imported = simd::make_bitmap(records.size(), [&](size_t i) { return records[i].is_imported; });
+        simd::Bitmap blacklist = simd::make_bitmap(records.size(), [&](size_t i) { return records[i].is_blacklist; });
+        result.extra_json["amount_summary"] = {
+            {"imported", summary(simd::reduce_masked(amounts.data(), imported.data(), amounts.size()))},
+            {"blacklist", summary(simd::reduce_masked(amounts.data(), blacklist.data(), amounts.size()))}
+        };
+        // 分位数：在 amounts 上原地部分选择，一次求出 p25/p50/p75/p95
+        std::vector<double> qs = select_quantiles(amounts, DEFAULT_QUANTILES);
+        result.median_amount = qs[1];
+        result.extra_json["amount_quantiles"] = {{"p25", qs[0]}, {"p50", qs[1]}, {"p75", qs[2]}, {"p95", qs[3]}};
     }
     // 按类别/产品统计
+    std::map<std::string, std::vector<double>> category_values;
     for (const auto& r : records) {
         result.category_total[r.type] += r.amount;
+        category_values[r.type].push_back(r.amount);
         // 已移除 product_total 字段的统计
     }
-    // ====== 复杂异常检测（Isolation Forest 模拟） ======
+    // 各类别分位数（分组一次，组内原地选择）
+    for (auto& [type, vals] : category_values) {
+        std::vector<double> qs = select_quantiles(vals, DEFAULT_QUANTILES);
+        result.extra_json["category_quantiles"][type] = {{"p25", qs[0]}, {"p50", qs[1]}, {"p75", qs[2]}, {"p95", qs[3]}};
+    }
+    // ====== 滑动窗口趋势（7/30/90 日移动指标） ======
+    DailySeries daily_total;
+    std::map<std::string, DailySeries> daily_by_category;
+    build_daily_series(records, daily_total, daily_by_category, weights);
+    for (size_t i = 0; i < daily_total.values.size(); ++i) {
+        result.time_series.push_back({format_day(daily_total.first_day + (int)i), daily_total.values[i]});
+    }
+    RollingWindowEngine rolling;
+    result.extra_json["rolling_stats"]["total"] = rolling.to_json(daily_total);
+    for (const auto& [type, series] : daily_by_category) {
+        result.extra_json["rolling_stats"]["categories"][type] = rolling.to_json(series);
+    }
+    // ====== 记录级特征矩阵（异常检测与聚类共享，只构建一次） ======
+    FeatureMatrix features = build_feature_matrix(records);
+    for (size_t c = 0; c < features.dim; ++c) {
+        result.extra_json["feature_matrix"][FeatureMatrix::column_names[c]] = {{"mean", features.mean[c]}, {"scale", features.scale[c]}};
+    }
+    // ====== 复杂异常检测（按类别分组的 Isolation Forest，组内相对得分） ======
     AnomalyDetector anomaly_detector;
-    // 假设异常比例为 0.05 (5%)
-    std::vector<size_t> anomaly_indices = anomaly_detector.detect(records, 0.05);
-    for (size_t idx : anomaly_indices) {
+    // 假设异常比例为 0.05 (5%)，在每个类别内部取分位数，避免最贵的类别独占全部名额
+    GroupedAnomalies grouped = anomaly_detector.detect_grouped(records, features, AnomalyDetector::GroupBy::Type, 0.05);
+    for (size_t idx : grouped.indices) {
         result.anomalies.push_back(records[idx].remark + " (" + std::to_string(records[idx].amount) + ")");
     }
+    result.anomaly_scores = std::move(grouped.scores);
+    // 记录数不足的类别合并为一组，单独放在 pooled 下，不与真实类别名冲突
+    result.extra_json["grouped_anomalies"] = {{"groups", nlohmann::json::object()}};
+    for (size_t g = 0; g < grouped.group_names.size(); ++g) {
+        nlohmann::json stats = {
+            {"records", grouped.group_sizes[g]}, {"flagged", grouped.group_flagged[g]}, {"threshold", grouped.group_thresholds[g]}
+        };
+        if (g == grouped.pooled_group) result.extra_json["grouped_anomalies"]["pooled"] = std::move(stats);
+        else result.extra_json["grouped_anomalies"]["groups"][grouped.group_names[g]] = std::move(stats);
+    }
+    // ====== 日总额季节性异常（MSTL 残差，归因到记录） ======
+    nlohmann::json seasonal_json = nlohmann::json::array();
+    for (const auto& a : anomaly_detector.detect_seasonal(records, daily_total.values, daily_total.first_day)) {
+        nlohmann::json contributors = nlohmann::json::array();
+        for (size_t idx : a.records) {
+            contributors.push_back({{"index", idx}, {"remark", records[idx].remark}, {"amount", records[idx].amount}});
+        }
+        seasonal_json.push_back({{"date", format_day(a.day)}, {"total", a.total}, {"expected", a.expected},
+                                 {"residual", a.residual}, {"z", a.z}, {"records", std::move(contributors)}});
+    }
+    result.extra_json["seasonal_anomalies"] = std::move(seasonal_json);
+    // ====== 基于密度的离群点（LOF，KD 树 kNN） ======
+    std::vector<double> lof_scores;
+    std::vector<size_t> lof_indices = anomaly_detector.detect_lof(features, 0.05, 20, &lof_scores);
+    nlohmann::json lof_json = nlohmann::json::array();
+    for (size_t idx : lof_indices) {
+        lof_json.push_back({{"index", idx}, {"remark", records[idx].remark}, {"amount", records[idx].amount}, {"lof", lof_scores[idx]}});
+    }
+    result.extra_json["lof_anomalies"] = {{"k", 20}, {"threshold", AnomalyDetector::LOF_THRESHOLD}, {"anomalies", std::move(lof_json)}};
     // ====== 复杂KMeans风格聚类 ======
     ClusterAnalyzer cluster_analyzer;
     // 假设分为3个集群
@@ -59,13 +130,22 @@ AnalysisResult complex_analysis(const std::vector<Record>& records, const I18N&
         ar_cluster.avg_amount = tc.avg_amount;
         result.clusters.push_back(ar_cluster);
     }
-    // 更新集群标签为国际化文本
+    // 更新集群标签为国际化文本（簇已按质心从高到低排列）
     for (auto& cluster : result.clusters) {
         if (cluster.label == "Cluster 1") cluster.label = i18n.t("cluster_high");
         else if (cluster.label == "Cluster 2") cluster.label = i18n.t("cluster_mid");
         else if (cluster.label == "Cluster 3") cluster.label = i18n.t("cluster_low");
     }
 
+    // ====== 特征矩阵上的多维聚类（k-means++，区分"小额高频"与"小额偶发"等消费模式） ======
+    for (const auto& c : cluster_analyzer.kmeans_cluster(features, records, 3)) {
+        nlohmann::json centroid;
+        for (size_t d = 0; d < c.centroid.size(); ++d) centroid[FeatureMatrix::column_names[d]] = c.centroid[d];
+        result.extra_json["feature_clusters"].push_back({{"label", c.label}, {"records", c.member_indices.size()},
+                                                        {"cluster_total", c.cluster_total}, {"avg_amount", c.avg_amount},
+                                                        {"centroid", std::move(centroid)}});
+    }
+
     // ====== 复杂用户画像（多维特征：礼物、黑名单、进口、频率、均值等） ======
     std::map<std::string, AnalysisResult::UserProfile> profiles;
     for (size_t i = 0; i < records.size(); ++i) {
@@ -106,156 +186,8 @@ AnalysisResult complex_analysis(const std::vector<Record>& records, const I18N&
         result.user_profiles.push_back(kv.second);
     }
 
-    // ====== 修正版：安全时间、排除当前月、指数平滑、跨月日分布 ======
-    // 1. 安全获取当前时间
-    auto chrono_now = std::chrono::system_clock::now();
-    time_t t_now = std::chrono::system_clock::to_time_t(chrono_now);
-    struct tm tm_now;
-    localtime_r(&t_now, &tm_now);
-    char buf_month[16];
-    snprintf(buf_month, sizeof(buf_month), "%04d-%02d", tm_now.tm_year+1900, tm_now.tm_mon+1);
-    const std::string current_month = buf_month;
-    // 2. 月度聚合，排除当前月
-    std::map<std::string, double> historical_month_total;
-    std::map<std::string, std::map<std::string, double>> month_day_total;
-    for (const auto& r : records) {
-        std::string month = r.time.substr(0, 7);
-        if (month == current_month) continue;
-        historical_month_total[month] += r.amount;
-        month_day_total[month][r.time] += r.amount;
-    }
-    // 3. 指数平滑预测
-    std::vector<double> hist_vals;
-    std::vector<std::string> hist_months;
-    for (const auto& [mon, val] : historical_month_total) {
-        hist_months.push_back(mon);
-        hist_vals.push_back(val);
-    }
-    double this_month_pred = 0, next_month_pred = 0;
-    if (!hist_vals.empty()) {
-        const double alpha = 0.7;
-        this_month_pred = hist_vals.back();
-        for (int i = hist_vals.size()-1; i > 0; --i)
-            this_month_pred = alpha * hist_vals[i] + (1-alpha) * this_month_pred;
-        if (hist_vals.size() >= 2)
-            next_month_pred = this_month_pred + 0.5*(hist_vals.back() - hist_vals[hist_vals.size()-2]);
-        else
-            next_month_pred = this_month_pred;
-    }
-
-
-    // === 进度修正：本月已发生+剩余天数预测 ===
-    // 统计本月已发生金额和天数
-    double current_partial = 0.0;
-    int current_days = 0;
-    int year = tm_now.tm_year+1900, month = tm_now.tm_mon+1;
-    char buf_this[16];
-    snprintf(buf_this, sizeof(buf_this), "%04d-%02d", year, month);
-    std::string this_month = buf_this;
-    // 安全日期计算函数提前
-    auto get_days_in_month = [](int y, int m) -> int {
-        static const int days[12] = {31,28,31,30,31,30,31,31,30,31,30,31};
-        if (m == 2 && ((y%4==0&&y%100!=0)||y%400==0)) return 29;
-        return days[m-1];
-    };
-    for (const auto& r : records) {
-        if (r.time.substr(0,7) == this_month) {
-            current_partial += r.amount;
-            current_days++;
-        }
-    }
-    int days_this = get_days_in_month(year, month);
-    int remaining_days = days_this - current_days;
-    double adjusted_this_month = current_partial + (this_month_pred * remaining_days / (days_this > 0 ? days_this : 30));
-
-    // === 季节性因子补偿：下月 ===
-    // 统计历史同月均值
-    int next_year = year, next_month = month+1;
-    if (next_month > 12) { next_month = 1; ++next_year; }
-    char buf_next[16];
-    snprintf(buf_next, sizeof(buf_next), "%04d-%02d", next_year, next_month);
-    std::string next_month_str = buf_next;
-    double seasonal_index = 1.0;
-    if (!hist_months.empty()) {
-        // 取历史所有同月
-        std::vector<double> same_month_vals;
-        for (size_t i = 0; i < hist_months.size(); ++i) {
-            int m = std::stoi(hist_months[i].substr(5,2));
-            if (m == next_month) same_month_vals.push_back(hist_vals[i]);
-        }
-        if (!same_month_vals.empty()) {
-            double mean_hist = std::accumulate(hist_vals.begin(), hist_vals.end(), 0.0) / hist_vals.size();
-            double mean_same = std::accumulate(same_month_vals.begin(), same_month_vals.end(), 0.0) / same_month_vals.size();
-            if (mean_hist > 1e-9) seasonal_index = mean_same / mean_hist;
-        }
-    }
-    double seasonal_next_month_pred = next_month_pred * seasonal_index;
-
-    // AR模型改进预测
-    double ar_prediction = seasonal_next_month_pred;
-    if (hist_vals.size() >= 2) {
-        double phi1 = 0.5; // 自回归系数，可调
-        double mean_hist = std::accumulate(hist_vals.begin(), hist_vals.end(), 0.0) / hist_vals.size();
-        ar_prediction = mean_hist + phi1 * (hist_vals.back() - mean_hist);
-        seasonal_next_month_pred = (seasonal_next_month_pred + ar_prediction) / 2.0; // 结合指数平滑和AR
-    }
-
-    // === 置信区间 ===
-    double std_dev = 0.0;
-    if (hist_vals.size() > 1) {
-        double mean = std::accumulate(hist_vals.begin(), hist_vals.end(), 0.0) / hist_vals.size();
-        for (auto v : hist_vals) std_dev += (v-mean)*(v-mean);
-        std_dev = sqrt(std_dev / (hist_vals.size()-1));
-    }
-    double ci_low = seasonal_next_month_pred - std_dev;
-    double ci_high = seasonal_next_month_pred + std_dev;
-    // 4. 多月每日比例聚合
-    std::array<double, 31> day_ratios{};
-    int valid_months = 0;
-    for (const auto& [month, _] : historical_month_total) {
-        if (month_day_total[month].empty()) continue;
-        double month_sum = 0;
-        for (const auto& [date, amount] : month_day_total[month]) month_sum += amount;
-        if (month_sum < 1e-9) continue;
-        for (const auto& [date, amount] : month_day_total[month]) {
-            int day = std::stoi(date.substr(8,2));
-            if (day >=1 && day <=31) day_ratios[day-1] += amount/month_sum;
-        }
-        valid_months++;
-    }
-    if (valid_months > 0) {
-        for (int i=0; i<31; ++i) day_ratios[i] /= valid_months;
-    }
-    // ...已提前定义get_days_in_month...
-    // 6. 生成本月、下月每日预测
-    int days_next = get_days_in_month(next_year, next_month);
-    nlohmann::json daily_this, daily_next;
-    for (int d = 1; d <= days_this; ++d) {
-        double ratio = day_ratios[d-1] > 1e-9 ? day_ratios[d-1] : 1.0/days_this;
-        double val = this_month_pred * ratio;
-        char datebuf[16]; snprintf(datebuf, sizeof(datebuf), "%s-%02d", this_month.c_str(), d);
-        daily_this.push_back({{"date", datebuf}, {"value", val}});
-    }
-    for (int d = 1; d <= days_next; ++d) {
-        double ratio = day_ratios[d-1] > 1e-9 ? day_ratios[d-1] : 1.0/days_next;
-        double val = seasonal_next_month_pred * ratio;
-        char datebuf[16]; snprintf(datebuf, sizeof(datebuf), "%s-%02d", next_month_str.c_str(), d);
-        daily_next.push_back({{"date", datebuf}, {"value", val}});
-    }
-    result.extra_json["monthly_predict"] = {
-        {"this_month", {
-            {"month", this_month},
-            {"total", this_month_pred},
-            {"adjusted", adjusted_this_month}
-        }},
-        {"next_month", {
-            {"month", next_month_str},
-            {"total", next_month_pred},
-            {"seasonal_adjusted", seasonal_next_month_pred},
-            {"confidence_interval", {ci_low, ci_high}}
-        }}
-    };
-    result.extra_json["daily_predict"] = {{"this_month", daily_this}, {"next_month", daily_next}};
+    // ====== 月度/每日消费预测 ======
+    forecast_analysis(records, result, forecast_state, weights);
 
 
     // ====== 复杂情感分析 ======
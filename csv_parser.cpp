@@ -56,10 +56,15 @@ static void parse_time(Record& record) {
 
 std::vector<Record> parse_csv(const std::string& filename) {
     std::vector<Record> records;
+    parse_csv_stream(filename, [&](Record&& record) { records.push_back(std::move(record)); });
+    return records;
+}
+
+bool parse_csv_stream(const std::string& filename, const std::function<void(Record&&)>& on_record) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "无法打开文件: " << filename << std::endl;
-        return records;
+        return false;
     }
     std::string line;
     getline(file, line); // 跳过标题
@@ -140,7 +145,7 @@ if (!std::getline(ss, record.time, ',')) continue;
         } catch (...) {
             std::cerr << "警告: 第" << line_num << "行时间解析失败: " << record.time << std::endl;
         }
-        records.push_back(record);
+        on_record(std::move(record));
     }
-    return records;
+    return true;
 }
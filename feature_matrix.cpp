@@ -0,0 +1,77 @@
+#include "include/feature_matrix.h"
+#include "include/date_util.h"
+#include <cmath>
+#include <string>
+#include <unordered_map>
+
+const char* const FeatureMatrix::column_names[FeatureMatrix::ColumnCount] = {
+    "amount", "unit_price", "quantity", "weekday", "category_z", "product_frequency"
+};
+
+static double signed_log1p(double x) {
+    return std::copysign(std::log1p(std::abs(x)), x);
+}
+
+FeatureMatrix build_feature_matrix(const std::vector<Record>& records) {
+    FeatureMatrix fm;
+    const size_t n = records.size();
+    const size_t dim = fm.dim;
+    fm.rows = n;
+    fm.mean.assign(dim, 0.0);
+    fm.scale.assign(dim, 1.0);
+    if (n == 0) return fm;
+
+    // 1. 分组统计：类别内金额均值/方差（Welford）、商品出现次数
+    struct Moments { double n = 0, mean = 0, m2 = 0; };
+    std::unordered_map<std::string, Moments> by_type;
+    std::unordered_map<std::string, size_t> product_count;
+    for (const auto& r : records) {
+        Moments& m = by_type[r.type];
+        m.n += 1;
+        const double delta = r.amount - m.mean;
+        m.mean += delta / m.n;
+        m.m2 += delta * (r.amount - m.mean);
+        product_count[r.product_name]++;
+    }
+
+    // 2. 原始特征（double 暂存），无效日期的星期列记为 NaN，稍后以均值填补
+    std::vector<double> raw(n * dim);
+    for (size_t i = 0; i < n; ++i) {
+        const Record& r = records[i];
+        double* x = raw.data() + i * dim;
+        const Moments& m = by_type[r.type];
+        const double sd = m.n > 1 ? std::sqrt(m.m2 / (m.n - 1)) : 0.0;
+        x[FeatureMatrix::Amount] = signed_log1p(r.amount);
+        x[FeatureMatrix::UnitPrice] = signed_log1p(r.unit_price);
+        x[FeatureMatrix::Quantity] = signed_log1p(r.quantity);
+        // 1970-01-01 为星期四；取周一为 0
+        x[FeatureMatrix::Weekday] = valid_date(r.time_tm) ? ((day_index(r.time_tm) % 7 + 10) % 7) : NAN;
+        x[FeatureMatrix::CategoryZ] = sd > 1e-9 ? (r.amount - m.mean) / sd : 0.0;
+        x[FeatureMatrix::ProductFrequency] = static_cast<double>(product_count[r.product_name]) / n;
+    }
+
+    // 3. 按列标准化
+    for (size_t c = 0; c < dim; ++c) {
+        double sum = 0.0, count = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const double v = raw[i * dim + c];
+            if (!std::isnan(v)) { sum += v; count += 1; }
+        }
+        const double mu = count > 0 ? sum / count : 0.0;
+        double ss = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const double v = raw[i * dim + c];
+            if (!std::isnan(v)) ss += (v - mu) * (v - mu);
+        }
+        const double sd = count > 1 ? std::sqrt(ss / (count - 1)) : 0.0;
+        fm.mean[c] = mu;
+        fm.scale[c] = sd > 1e-12 ? sd : 1.0;
+    }
+    fm.values.resize(n * dim);
+    for (size_t i = 0; i < n * dim; ++i) {
+        const size_t c = i % dim;
+        const double v = std::isnan(raw[i]) ? fm.mean[c] : raw[i];
+        fm.values[i] = static_cast<float>((v - fm.mean[c]) / fm.scale[c]);
+    }
+    return fm;
+}
@@ -0,0 +1,299 @@
+#include "include/forecast_analyzer.h"
+#include "include/forecaster.h"
+#include "include/holt_winters.h"
+#include "include/model_selection.h"
+#include "include/arima.h"
+#include "include/bootstrap.h"
+#include "include/rolling_window.h"
+#include "include/date_util.h"
+#include "include/calendar.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+// 前缀校验和：普通和与按位置加权和。只比普通和时，两个月金额互换之类保持总和的改写会被误判为未变
+static std::pair<double, double> prefix_checksums(const std::vector<double>& series, size_t count) {
+    double sum = 0.0, weighted = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += series[i];
+        weighted += (i + 1) * series[i];
+    }
+    return {sum, weighted};
+}
+
+static bool same_checksum(double a, double b) {
+    return std::abs(a - b) <= 1e-6 * std::max(1.0, std::abs(a));
+}
+
+// 增量续接：saved 记录上次覆盖的序列起点 origin、观测数 count、前缀校验和 checksum / weighted_checksum
+// 与上次全量拟合时的观测数 refit_at。若 saved 仍是当前序列 [0, upto) 的前缀，且自上次全量拟合以来增长不超过 1/4，
+// 则恢复状态后逐点 O(1) update；否则（历史被改写、首次运行或需要重估参数）全量拟合。返回写回磁盘的新状态。
+template <typename Model, typename FitFn>
+static nlohmann::json resume_or_fit(Model& model, const nlohmann::json& saved, const std::vector<double>& series,
+                                    int origin, size_t upto, FitFn&& fit, bool& resumed) {
+    resumed = false;
+    size_t refit_at = upto;
+    try {
+        if (saved.is_object() && saved.at("origin").get<int>() == origin) {
+            const size_t count = saved.at("count").get<size_t>();
+            const size_t last_refit = saved.at("refit_at").get<size_t>();
+            if (count > 0 && count <= upto && upto <= last_refit + last_refit / 4) {
+                const auto [sum, weighted] = prefix_checksums(series, count);
+                if (same_checksum(sum, saved.at("checksum").get<double>()) &&
+                    same_checksum(weighted, saved.at("weighted_checksum").get<double>()) && model.restore(saved.at("model"))) {
+                    for (size_t i = count; i < upto; ++i) model.update(series[i]);
+                    resumed = true;
+                    refit_at = last_refit;
+                }
+            }
+        }
+    } catch (const nlohmann::json::exception&) {
+        resumed = false;
+    }
+    if (!resumed) fit(std::vector<double>(series.begin(), series.begin() + upto));
+    const auto [sum, weighted] = prefix_checksums(series, upto);
+    return {
+        {"origin", origin},
+        {"count", upto},
+        {"checksum", sum},
+        {"weighted_checksum", weighted},
+        {"refit_at", refit_at},
+        {"model", model.state()}
+    };
+}
+
+// 月度/每日消费预测：排除当前月的历史月度序列上拟合 Holt-Winters（水平/趋势/季节），并在保留尾段上
+// 自动选择模型族与参数；每日预测由周季节日模型给出形状、按月度总额调和
+void forecast_analysis(const std::vector<Record>& records, AnalysisResult& result, const std::string& state_path,
+                       const std::vector<double>* weights) {
+    // 0. 读取上次运行持久化的模型状态（文件不存在即首次运行）
+    nlohmann::json saved_state = nlohmann::json::object(), new_state;
+    if (!state_path.empty()) {
+        std::ifstream in(state_path);
+        if (in.is_open()) {
+            saved_state = nlohmann::json::parse(in, nullptr, false);
+            if (!saved_state.is_object()) {
+                std::cerr << "Warning: ignoring unreadable forecast state " << state_path << std::endl;
+                saved_state = nlohmann::json::object();
+            }
+        }
+    }
+    bool resumed = false;
+    // 1. 安全获取当前时间
+    auto chrono_now = std::chrono::system_clock::now();
+    time_t t_now = std::chrono::system_clock::to_time_t(chrono_now);
+    struct tm tm_now;
+    localtime_r(&t_now, &tm_now);
+    int year = tm_now.tm_year+1900, month = tm_now.tm_mon+1;
+    const int current_index = year * 12 + month - 1; // 年*12+月-1
+    std::string this_month = format_month(current_index);
+    // 2. 稠密日历：一次遍历按整数日期累计 [月][日] 金额
+    DenseCalendar calendar;
+    calendar.build(records, weights);
+    // 3. 历史月度序列：日历覆盖的连续月份，排除当前月（位于末尾时截去，位于中间时记 0）
+    std::vector<double> hist_vals;
+    int first_hist_index = calendar.first_month(), last_hist_index = calendar.last_month();
+    if (last_hist_index == current_index) --last_hist_index;
+    if (first_hist_index == current_index) ++first_hist_index;
+    for (int idx = first_hist_index; !calendar.empty() && idx <= last_hist_index; ++idx) {
+        hist_vals.push_back(idx == current_index ? 0.0 : calendar.month_total(idx));
+    }
+
+    // === 进度修正：本月已发生+剩余天数预测 ===
+    // 本月已发生金额直接取日历当月合计，剩余天数按今天的日期计算
+    const double current_partial = calendar.month_total(current_index);
+    const int current_days = tm_now.tm_mday;
+    int next_year = year, next_month = month+1;
+    if (next_month > 12) { next_month = 1; ++next_year; }
+    std::string next_month_str = format_month(next_year * 12 + next_month - 1);
+
+    // 4. Holt-Winters 月度预测（季节周期 12，自动选加法/乘法季节）
+    HoltWinters monthly_model;
+    double this_month_pred = 0, next_month_pred = 0, seasonal_next_month_pred = 0;
+    double ci_low = 0, ci_high = 0;
+    int steps_this = 1;
+    bool monthly_resumed = false;
+    if (!hist_vals.empty()) {
+        new_state["monthly"] = resume_or_fit(monthly_model, saved_state.value("monthly", nlohmann::json()), hist_vals,
+                                             first_hist_index, hist_vals.size(),
+                                             [&](const std::vector<double>& v) { monthly_model.fit_auto(v, 12); }, resumed);
+        monthly_resumed = resumed;
+        result.extra_json["forecast_state"]["monthly"] = resumed ? "resumed" : "refit";
+        steps_this = std::max(1, (year * 12 + month - 1) - last_hist_index);
+        this_month_pred = std::max(0.0, monthly_model.forecast_at(steps_this));
+        next_month_pred = std::max(0.0, monthly_model.deseasonalized_at(steps_this + 1));
+        seasonal_next_month_pred = std::max(0.0, monthly_model.forecast_at(steps_this + 1));
+        double sigma = monthly_model.residual_std();
+        ci_low = std::max(0.0, seasonal_next_month_pred - 1.96 * sigma);
+        ci_high = seasonal_next_month_pred + 1.96 * sigma;
+        result.extra_json["holt_winters"]["monthly"] = monthly_model.to_json();
+    }
+    // 逐序列自动选模：保留尾段上评估参数网格，胜出者驱动 monthly_predict；数据过短时沿用上面的 Holt-Winters。
+    // 月度模型续接时沿用上次选出的候选，只在全量重拟合时重新评估整个网格
+    const std::vector<ForecastCandidate> grid = candidate_grid();
+    ModelSelection selection;
+    const bool selection_resumed = monthly_resumed && selection.restore(saved_state.value("selection", nlohmann::json()), grid);
+    if (!selection_resumed) selection = select_model(hist_vals, first_hist_index, grid);
+    new_state["selection"] = selection.state();
+    result.extra_json["model_selection"] = selection.to_json();
+    if (selection.selected) result.extra_json["forecast_state"]["selection"] = selection_resumed ? "resumed" : "refit";
+    // 区间模拟所用的模型必须是给出点预测的那个：未选模时为上面的月度模型，选中 Holt-Winters 族时按其参数重拟合；
+    // 其他族（AR、ARIMA、平滑组合）只保留自身的解析区间，不输出月度分位数带
+    const HoltWinters* band_model = selection.selected ? nullptr : &monthly_model;
+    HoltWinters selected_hw;
+    if (selection.selected) {
+        std::vector<double> mean, half;
+        selection.model.forecast(hist_vals.data(), hist_vals.size(), first_hist_index, steps_this + 1, mean, half);
+        this_month_pred = std::max(0.0, mean[steps_this - 1]);
+        seasonal_next_month_pred = std::max(0.0, mean[steps_this]);
+        // 只有 Holt-Winters 区分去季节基线，其余族的基线即预测值
+        if (fit_holt_winters_candidate(selection.model, hist_vals, selected_hw)) {
+            band_model = &selected_hw;
+            next_month_pred = std::max(0.0, selected_hw.deseasonalized_at(steps_this + 1));
+        } else {
+            next_month_pred = seasonal_next_month_pred;
+        }
+        ci_low = std::max(0.0, seasonal_next_month_pred - half[steps_this]);
+        ci_high = seasonal_next_month_pred + half[steps_this];
+    }
+    // 块自助法分位数带：按上面的 Holt-Winters 状态递推模拟路径，路径相对其点预测的偏移叠加到（截断到非负的）预测上，
+    // 置信区间取最外两个分位数（默认 q5–q95）
+    nlohmann::json bands_json;
+    QuantileBands monthly_bands;
+    if (band_model) monthly_bands = bootstrap_bands(*band_model, band_model->residuals(hist_vals), steps_this + 1);
+    if (!monthly_bands.bands.empty()) {
+        const size_t h_this = steps_this - 1, h_next = steps_this;
+        ci_low = std::max(0.0, seasonal_next_month_pred + monthly_bands.offset(0, h_next));
+        ci_high = std::max(0.0, seasonal_next_month_pred + monthly_bands.offset(monthly_bands.probs.size() - 1, h_next));
+        bands_json = {{"quantiles", monthly_bands.probs}, {"paths", monthly_bands.paths}, {"block", monthly_bands.block}};
+        bands_json["monthly"]["this_month"] = monthly_bands.values_at(h_this, this_month_pred - monthly_bands.point[h_this]);
+        bands_json["monthly"]["next_month"] = monthly_bands.values_at(h_next, seasonal_next_month_pred - monthly_bands.point[h_next]);
+    }
+    int days_this = DenseCalendar::days_in_month(current_index);
+    int remaining_days = std::max(0, days_this - current_days);
+    double adjusted_this_month = current_partial + (this_month_pred * remaining_days / (days_this > 0 ? days_this : 30));
+
+    // AR(p) 对照模型：Yule-Walker/Levinson-Durbin 拟合，按 BIC 自动定阶
+    if (hist_vals.size() >= 2) {
+        TimeSeriesForecaster ar_model;
+        new_state["ar"] = resume_or_fit(ar_model, saved_state.value("ar", nlohmann::json()), hist_vals,
+                                        first_hist_index, hist_vals.size(), [&](const std::vector<double>& v) {
+            ar_model.fit_auto(v, std::min<int>(6, v.size() / 2), TimeSeriesForecaster::Criterion::BIC);
+        }, resumed);
+        // 数据陈旧时多步递推会收敛到均值
+        int steps = std::clamp(steps_this + 1, 1, 24);
+        result.extra_json["ar_model"] = ar_model.to_json();
+        result.extra_json["ar_model"]["next_month"] = ar_model.predict(steps).back();
+    }
+
+    // SARIMA 模型：Kalman 滤波精确似然，差分与阶数自动选择，区间由 psi 权重给出
+    Arima arima_model;
+    if (arima_model.fit_auto(hist_vals, 12)) {
+        Arima::Forecast f = arima_model.forecast(steps_this + 1);
+        const double pred = f.mean.back(), se = f.std_err.back();
+        result.extra_json["arima"] = arima_model.to_json();
+        result.extra_json["arima"]["next_month"] = pred;
+        result.extra_json["arima"]["prediction_interval"] = {pred - 1.96 * se, pred + 1.96 * se};
+    }
+
+    // 5. 多月每日比例聚合（日模型不可用时的回退）
+    std::array<double, 31> day_ratios{};
+    int valid_months = 0;
+    for (int idx = first_hist_index; idx <= last_hist_index && !hist_vals.empty(); ++idx) {
+        const double month_sum = hist_vals[idx - first_hist_index];
+        if (month_sum < 1e-9) continue;
+        const auto& days = calendar.days_of(idx);
+        for (int d = 0; d < 31; ++d) day_ratios[d] += days[d] / month_sum;
+        valid_months++;
+    }
+    if (valid_months > 0) {
+        for (int i=0; i<31; ++i) day_ratios[i] /= valid_months;
+    }
+    // 6. 每日预测：Holt-Winters 周季节（周期 7）日模型给出日间形状，
+    //    再按月度预测总额等比例调和；日序列过短时退回历史各日占比
+    DailySeries daily_series;
+    std::map<std::string, DailySeries> daily_by_category;
+    build_daily_series(records, daily_series, daily_by_category, weights);
+    HoltWinters daily_model;
+    if (daily_series.values.size() >= 14) {
+        // 最后一天可能仍在累计：写回的状态只覆盖之前的完整日，之后再把最后一天 update 进模型本身用于本次预测
+        // （这一步不进入持久化状态，下次运行会用届时的完整值重新追加）
+        new_state["daily"] = resume_or_fit(daily_model, saved_state.value("daily", nlohmann::json()), daily_series.values,
+                                           daily_series.first_day, daily_series.values.size() - 1,
+                                           [&](const std::vector<double>& v) { daily_model.fit_auto(v, 7); }, resumed);
+        result.extra_json["forecast_state"]["daily"] = resumed ? "resumed" : "refit";
+        daily_model.update(daily_series.values.back());
+        result.extra_json["holt_winters"]["daily"] = daily_model.to_json();
+    }
+    const int last_day = daily_series.first_day + static_cast<int>(daily_series.values.size()) - 1;
+    QuantileBands daily_bands;
+    const int daily_horizon = days_from_civil(next_year, next_month, DenseCalendar::days_in_month(next_year * 12 + next_month - 1)) - last_day;
+    if (daily_model.is_fitted() && daily_horizon > 0) {
+        daily_bands = bootstrap_bands(daily_model, daily_model.residuals(daily_series.values), daily_horizon);
+    }
+    auto build_daily = [&](int y, int m, const std::string& month_str, double month_total) {
+        const int days = DenseCalendar::days_in_month(y * 12 + m - 1);
+        std::vector<double> vals(days, 0.0);
+        double sum = 0.0;
+        if (daily_model.is_fitted()) {
+            for (int d = 1; d <= days; ++d) {
+                int day = days_from_civil(y, m, d);
+                int h = day - last_day;
+                double v = 0.0;
+                if (h > 0) v = daily_model.forecast_at(h);
+                else if (day >= daily_series.first_day) v = daily_series.values[day - daily_series.first_day]; // 已发生日取实际值
+                vals[d-1] = std::max(0.0, v);
+                sum += vals[d-1];
+            }
+        }
+        for (int d = 1; d <= days; ++d) {
+            double ratio;
+            if (sum > 1e-9) ratio = vals[d-1] / sum;
+            else ratio = day_ratios[d-1] > 1e-9 ? day_ratios[d-1] : 1.0/days;
+            vals[d-1] = month_total * ratio;
+        }
+        nlohmann::json out = nlohmann::json::array();
+        for (int d = 1; d <= days; ++d) {
+            char datebuf[16]; snprintf(datebuf, sizeof(datebuf), "%s-%02d", month_str.c_str(), d);
+            out.push_back({{"date", datebuf}, {"value", vals[d-1]}});
+            // 未来日的分位数带按与点预测相同的比例调和到月度总额
+            const int h = days_from_civil(y, m, d) - last_day;
+            if (h > 0 && !daily_bands.bands.empty() && sum > 1e-9) {
+                nlohmann::json band = daily_bands.values_at(h - 1, 0.0, month_total / sum);
+                band["date"] = datebuf;
+                bands_json["daily"].push_back(band);
+            }
+        }
+        return out;
+    };
+    nlohmann::json daily_this = build_daily(year, month, this_month, this_month_pred);
+    nlohmann::json daily_next = build_daily(next_year, next_month, next_month_str, seasonal_next_month_pred);
+    result.extra_json["monthly_predict"] = {
+        {"this_month", {
+            {"month", this_month},
+            {"total", this_month_pred},
+            {"adjusted", adjusted_this_month}
+        }},
+        {"next_month", {
+            {"month", next_month_str},
+            {"total", next_month_pred},
+            {"seasonal_adjusted", seasonal_next_month_pred},
+            {"confidence_interval", {ci_low, ci_high}}
+        }}
+    };
+    result.extra_json["daily_predict"] = {{"this_month", daily_this}, {"next_month", daily_next}};
+    if (!bands_json.is_null()) result.extra_json["prediction_bands"] = bands_json;
+
+    if (!state_path.empty()) {
+        std::ofstream out(state_path);
+        if (!out.is_open()) {
+            std::cerr << "Warning: cannot write forecast state " << state_path << std::endl;
+            return;
+        }
+        out << new_state.dump();
+    }
+}
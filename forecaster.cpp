@@ -0,0 +1,180 @@
+#include "include/forecaster.h"
+#include "include/parallel.h"
+#include <algorithm>
+#include <cmath>
+
+void TimeSeriesForecaster::reset(int lag, bool select, Criterion crit) {
+    max_lag = std::max(lag, 0);
+    select_order = select;
+    criterion = crit;
+    n_obs = 0;
+    total = 0.0;
+    cross.assign(max_lag + 1, 0.0);
+    head.clear();
+    history.clear();
+}
+
+// O(p)：更新滞后交叉积和与首尾观测窗口
+void TimeSeriesForecaster::accumulate(double value) {
+    cross[0] += value * value;
+    const int kmax = std::min<int>(max_lag, static_cast<int>(history.size()));
+    for (int k = 1; k <= kmax; ++k) cross[k] += value * history[history.size() - k];
+    total += value;
+    n_obs++;
+    if (head.size() < static_cast<size_t>(max_lag)) head.push_back(value);
+    history.push_back(value);
+    if (history.size() > static_cast<size_t>(std::max(max_lag, 1))) history.erase(history.begin());
+}
+
+void TimeSeriesForecaster::fit(const std::vector<double>& data, int order) {
+    reset(order, false, Criterion::AIC);
+    for (double v : data) accumulate(v);
+    solve();
+}
+
+void TimeSeriesForecaster::fit_auto(const std::vector<double>& data, int max_order, Criterion criterion) {
+    reset(max_order, true, criterion);
+    for (double v : data) accumulate(v);
+    solve();
+}
+
+void TimeSeriesForecaster::update(double value) {
+    if (cross.empty()) reset(max_lag, select_order, criterion);
+    accumulate(value);
+    solve();
+}
+
+std::vector<TimeSeriesForecaster> TimeSeriesForecaster::fit_batch(const SeriesMatrix& series, int max_order,
+                                                                  Criterion criterion, unsigned threads) {
+    std::vector<TimeSeriesForecaster> models(series.rows());
+    // 各行互不依赖，每个任务只写自己的 models[i]
+    parallel_for(series.rows(), [&](size_t i) {
+        auto& model = models[i];
+        model.reset(max_order, true, criterion);
+        const double* row = series.row(i);
+        for (size_t t = 0; t < series.length; ++t) model.accumulate(row[t]);
+        model.solve();
+    }, threads);
+    return models;
+}
+
+void TimeSeriesForecaster::solve() {
+    ar_coeffs.clear();
+    ic_values.clear();
+    mean = intercept = sigma2 = 0.0;
+    ar_order = 0;
+    const int n = static_cast<int>(n_obs);
+    if (n == 0) return;
+    mean = total / n;
+    intercept = mean;
+    const int order_cap = std::clamp(max_lag, 0, n - 1);
+    // 由充分统计量展开中心化自协方差（除以 n，保证 Toeplitz 矩阵半正定）：
+    // sum_{t>=k} (x_t - m)(x_{t-k} - m) = cross[k] - m * (去掉前 k 个的和 + 去掉后 k 个的和) + (n-k) m^2
+    std::vector<double> gamma(order_cap + 1);
+    double head_sum = 0.0, tail_sum = 0.0;
+    for (int k = 0; k <= order_cap; ++k) {
+        if (k > 0) {
+            head_sum += head[k - 1];
+            tail_sum += history[history.size() - k];
+        }
+        gamma[k] = (cross[k] - mean * ((total - head_sum) + (total - tail_sum)) + (n - k) * mean * mean) / n;
+    }
+    sigma2 = gamma[0];
+
+    // Levinson-Durbin：phi 为当前阶系数，err 为当前阶一步预测误差方差
+    std::vector<double> phi, prev, best = {};
+    double err = gamma[0];
+    auto criterion_value = [&](double e, int k) {
+        double ll = n * std::log(std::max(e, 1e-12));
+        return criterion == Criterion::BIC ? ll + (k + 1) * std::log((double)n) : ll + 2.0 * (k + 1);
+    };
+    double best_ic = criterion_value(err, 0), best_err = err;
+    int best_order = 0;
+    ic_values.push_back(best_ic);
+    for (int k = 1; k <= order_cap && err > 1e-12; ++k) {
+        double acc = gamma[k];
+        for (int j = 1; j < k; ++j) acc -= phi[j - 1] * gamma[k - j];
+        const double kappa = acc / err;
+        prev = phi;
+        phi.assign(k, 0.0);
+        for (int j = 1; j < k; ++j) phi[j - 1] = prev[j - 1] - kappa * prev[k - j - 1];
+        phi[k - 1] = kappa;
+        err *= (1.0 - kappa * kappa);
+        double ic = criterion_value(err, k);
+        ic_values.push_back(ic);
+        if (!select_order || ic < best_ic) {
+            best_ic = ic;
+            best = phi;
+            best_err = err;
+            best_order = k;
+        }
+    }
+    ar_order = best_order;
+    ar_coeffs = best;
+    sigma2 = best_err;
+    double phi_sum = 0.0;
+    for (double c : ar_coeffs) phi_sum += c;
+    intercept = mean * (1.0 - phi_sum);
+}
+
+std::vector<double> TimeSeriesForecaster::predict(int steps) const {
+    std::vector<double> result;
+    if (history.empty()) return result;
+    // y_t = c + sum phi_i * y_{t-i}，window 末尾为最新值
+    std::vector<double> window = history;
+    for (int s = 0; s < steps; ++s) {
+        double pred = intercept;
+        for (int i = 0; i < ar_order; ++i) pred += ar_coeffs[i] * window[window.size() - 1 - i];
+        result.push_back(pred);
+        window.push_back(pred);
+    }
+    return result;
+}
+
+nlohmann::json TimeSeriesForecaster::to_json() const {
+    nlohmann::json j;
+    j["ar_order"] = ar_order;
+    j["ar_coeffs"] = ar_coeffs;
+    j["intercept"] = intercept;
+    j["mean"] = mean;
+    j["sigma2"] = sigma2;
+    if (!ic_values.empty()) j["information_criteria"] = ic_values;
+    return j;
+}
+
+nlohmann::json TimeSeriesForecaster::state() const {
+    return {
+        {"max_lag", max_lag},
+        {"select_order", select_order},
+        {"criterion", criterion == Criterion::BIC ? "bic" : "aic"},
+        {"observations", n_obs},
+        {"total", total},
+        {"cross", cross},
+        {"head", head},
+        {"history", history}
+    };
+}
+
+bool TimeSeriesForecaster::restore(const nlohmann::json& j) {
+    TimeSeriesForecaster loaded;
+    try {
+        loaded.max_lag = j.at("max_lag").get<int>();
+        loaded.select_order = j.at("select_order").get<bool>();
+        loaded.criterion = j.at("criterion").get<std::string>() == "bic" ? Criterion::BIC : Criterion::AIC;
+        loaded.n_obs = j.at("observations").get<size_t>();
+        loaded.total = j.at("total").get<double>();
+        loaded.cross = j.at("cross").get<std::vector<double>>();
+        loaded.head = j.at("head").get<std::vector<double>>();
+        loaded.history = j.at("history").get<std::vector<double>>();
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+    const size_t lag = std::max(loaded.max_lag, 0);
+    if (loaded.cross.size() != lag + 1 || loaded.head.size() != std::min(lag, loaded.n_obs) ||
+        loaded.history.size() != std::min(std::max<size_t>(lag, 1), loaded.n_obs)) {
+        return false;
+    }
+    loaded.solve();
+    *this = std::move(loaded);
+    return true;
+}
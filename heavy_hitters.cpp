@@ -0,0 +1,145 @@
+#include "include/heavy_hitters.h"
+#include <algorithm>
+
+SpaceSaving::SpaceSaving(size_t capacity) : cap(std::max<size_t>(capacity, 1)) {
+    heap.reserve(cap);
+    pos.reserve(cap * 2);
+}
+
+void SpaceSaving::swap_nodes(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    pos[heap[a].key] = a;
+    pos[heap[b].key] = b;
+}
+
+void SpaceSaving::sift_up(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent].count <= heap[i].count) break;
+        swap_nodes(i, parent);
+        i = parent;
+    }
+}
+
+void SpaceSaving::sift_down(size_t i) {
+    const size_t n = heap.size();
+    while (true) {
+        size_t smallest = i, l = 2 * i + 1, r = l + 1;
+        if (l < n && heap[l].count < heap[smallest].count) smallest = l;
+        if (r < n && heap[r].count < heap[smallest].count) smallest = r;
+        if (smallest == i) break;
+        swap_nodes(i, smallest);
+        i = smallest;
+    }
+}
+
+void SpaceSaving::add(const std::string& key, double weight) {
+    if (weight <= 0) return; // Space-Saving 只支持非负增量，退款等负值不计入
+    auto it = pos.find(key);
+    if (it != pos.end()) {
+        heap[it->second].count += weight;
+        sift_down(it->second);
+        return;
+    }
+    if (heap.size() < cap) {
+        heap.push_back({key, weight, 0.0});
+        pos[key] = heap.size() - 1;
+        sift_up(heap.size() - 1);
+        return;
+    }
+    // 替换最小计数器：新键继承其计数作为误差上界
+    Entry& root = heap[0];
+    pos.erase(root.key);
+    root.error = root.count;
+    root.count += weight;
+    root.key = key;
+    pos[key] = 0;
+    sift_down(0);
+}
+
+double SpaceSaving::min_count() const {
+    return heap.size() < cap || heap.empty() ? 0.0 : heap[0].count;
+}
+
+void SpaceSaving::merge(const SpaceSaving& other) {
+    // 一方未跟踪的键，其计数与误差都按该方的 min_count 补上界
+    const double self_min = min_count(), other_min = other.min_count();
+    std::unordered_map<std::string, Entry> combined;
+    combined.reserve(heap.size() + other.heap.size());
+    for (const auto& e : heap) combined[e.key] = e;
+    for (const auto& e : other.heap) {
+        auto it = combined.find(e.key);
+        if (it == combined.end()) {
+            combined[e.key] = {e.key, e.count + self_min, e.error + self_min};
+        } else {
+            it->second.count += e.count;
+            it->second.error += e.error;
+        }
+    }
+    for (auto& [key, e] : combined) {
+        if (!other.pos.count(key)) {
+            e.count += other_min;
+            e.error += other_min;
+        }
+    }
+    std::vector<Entry> merged;
+    merged.reserve(combined.size());
+    for (auto& kv : combined) merged.push_back(std::move(kv.second));
+    if (merged.size() > cap) {
+        std::nth_element(merged.begin(), merged.begin() + cap, merged.end(), [](const Entry& a, const Entry& b) { return a.count > b.count; });
+        merged.resize(cap);
+    }
+    heap = std::move(merged);
+    std::make_heap(heap.begin(), heap.end(), [](const Entry& a, const Entry& b) { return a.count > b.count; });
+    pos.clear();
+    for (size_t i = 0; i < heap.size(); ++i) pos[heap[i].key] = i;
+}
+
+std::vector<SpaceSaving::Entry> SpaceSaving::top(size_t n) const {
+    std::vector<Entry> sorted = heap;
+    n = std::min(n, sorted.size());
+    std::partial_sort(sorted.begin(), sorted.begin() + n, sorted.end(), [](const Entry& a, const Entry& b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    sorted.resize(n);
+    return sorted;
+}
+
+nlohmann::json SpaceSaving::to_json(size_t n) const {
+    nlohmann::json arr = nlohmann::json::array();
+    for (const auto& e : top(n)) {
+        arr.push_back({{"key", e.key}, {"count", e.count}, {"error", e.error}, {"guaranteed", e.count - e.error}});
+    }
+    return arr;
+}
+
+HeavyHitterStats::HeavyHitterStats(size_t capacity)
+    : product_freq(capacity), product_spend(capacity), remark_freq(capacity), remark_spend(capacity), country_freq(capacity), country_spend(capacity) {}
+
+void HeavyHitterStats::add(const Record& r) {
+    product_freq.add(r.product_name);
+    product_spend.add(r.product_name, r.amount);
+    remark_freq.add(r.remark);
+    remark_spend.add(r.remark, r.amount);
+    if (!r.origin_country.empty()) {
+        country_freq.add(r.origin_country);
+        country_spend.add(r.origin_country, r.amount);
+    }
+}
+
+void HeavyHitterStats::merge(const HeavyHitterStats& other) {
+    product_freq.merge(other.product_freq);
+    product_spend.merge(other.product_spend);
+    remark_freq.merge(other.remark_freq);
+    remark_spend.merge(other.remark_spend);
+    country_freq.merge(other.country_freq);
+    country_spend.merge(other.country_spend);
+}
+
+nlohmann::json HeavyHitterStats::to_json(size_t k) const {
+    return {
+        {"products", {{"by_frequency", product_freq.to_json(k)}, {"by_spend", product_spend.to_json(k)}}},
+        {"remarks", {{"by_frequency", remark_freq.to_json(k)}, {"by_spend", remark_spend.to_json(k)}}},
+        {"countries", {{"by_frequency", country_freq.to_json(k)}, {"by_spend", country_spend.to_json(k)}}}
+    };
+}
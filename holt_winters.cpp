@@ -0,0 +1,204 @@
+#include "include/holt_winters.h"
+#include "include/optimizer.h"
+#include <algorithm>
+#include <cmath>
+
+double HoltWinters::step(const double* params, double y, double& l, double& t, std::vector<double>& s, size_t& p) const {
+    const double a = params[0], b = params[1], g = params[2], ph = params[3];
+    const double base = l + ph * t;
+    const double si = m > 0 ? s[p] : (mode == Seasonality::Multiplicative ? 1.0 : 0.0);
+    const double yhat = mode == Seasonality::Multiplicative ? base * si : base + si;
+    double new_l;
+    if (mode == Seasonality::Multiplicative) {
+        new_l = a * (si != 0 ? y / si : y) + (1 - a) * base;
+        if (m > 0 && new_l != 0) s[p] = g * (y / new_l) + (1 - g) * s[p];
+    } else {
+        new_l = a * (y - si) + (1 - a) * base;
+        if (m > 0) s[p] = g * (y - new_l) + (1 - g) * s[p];
+    }
+    t = b * (new_l - l) + (1 - b) * ph * t;
+    l = new_l;
+    if (m > 0) p = (p + 1) % m;
+    return yhat;
+}
+
+double HoltWinters::run(const std::vector<double>& data, const std::vector<double>& params, bool keep) {
+    const size_t n = data.size();
+    double l, t;
+    std::vector<double> s;
+    size_t start = 0; // 用于初始化、不计入误差的前若干个观测
+    if (m > 0) {
+        // 经典初始化：首个周期均值为水平，前两个周期均值之差为趋势，首周期相对水平的偏离为季节
+        double mean1 = 0.0, mean2 = 0.0;
+        for (int i = 0; i < m; ++i) { mean1 += data[i]; mean2 += data[i + m]; }
+        mean1 /= m;
+        mean2 /= m;
+        l = mean1;
+        t = (mean2 - mean1) / m;
+        s.resize(m);
+        for (int i = 0; i < m; ++i) {
+            s[i] = mode == Seasonality::Multiplicative ? data[i] / mean1 : data[i] - mean1;
+        }
+        // 初始水平对应首周期中点，回退到第 0 个观测之前
+        l -= t * (m - 1) / 2.0;
+    } else {
+        l = data[0];
+        t = n > 1 ? data[1] - data[0] : 0.0;
+        start = 1;
+    }
+    double err_sum = 0.0;
+    size_t err_count = 0;
+    size_t p = 0;
+    if (keep) fitted_values.assign(n, 0.0);
+    if (m == 0 && keep && n > 0) fitted_values[0] = data[0];
+    for (size_t i = start; i < n; ++i) {
+        const double y = data[i];
+        const double yhat = step(params.data(), y, l, t, s, p);
+        if (keep) fitted_values[i] = yhat;
+        if (m == 0 || i >= static_cast<size_t>(m)) {
+            err_sum += (y - yhat) * (y - yhat);
+            err_count++;
+        }
+    }
+    if (keep) {
+        level = l;
+        trend = t;
+        season = s;
+        pos = p;
+        n_obs = n;
+        sse = err_sum;
+        n_errors = err_count;
+        alpha = params[0]; beta = params[1]; gamma = params[2]; phi = params[3];
+    }
+    return err_count ? err_sum / err_count : 0.0;
+}
+
+void HoltWinters::fit(const std::vector<double>& data, int period, Seasonality seasonality) {
+    n_obs = 0;
+    fitted_values.clear();
+    if (data.empty()) return;
+    mode = seasonality;
+    m = (seasonality != Seasonality::None && period > 1 && data.size() >= 2 * static_cast<size_t>(period)) ? period : 0;
+    if (m == 0) mode = Seasonality::None;
+    if (mode == Seasonality::Multiplicative) {
+        for (double v : data) {
+            if (v <= 0) { mode = Seasonality::Additive; break; }
+        }
+    }
+    std::vector<double> start = {0.3, 0.05, m > 0 ? 0.1 : 0.0, 0.95};
+    std::vector<double> lower = {0.01, 0.0, 0.0, 0.8};
+    std::vector<double> upper = {0.99, 0.5, m > 0 ? 0.99 : 0.0, 1.0};
+    if (data.size() < 3) {
+        run(data, start, true);
+        return;
+    }
+    auto objective = [&](const std::vector<double>& x) { return run(data, x, false); };
+    OptimizeResult opt = nelder_mead_bounded(objective, start, lower, upper);
+    run(data, opt.x, true);
+}
+
+void HoltWinters::fit_auto(const std::vector<double>& data, int period) {
+    fit(data, period, Seasonality::Additive);
+    if (mode != Seasonality::Additive) return; // 已退化为无季节
+    HoltWinters mult;
+    mult.fit(data, period, Seasonality::Multiplicative);
+    if (mult.mode == Seasonality::Multiplicative && mult.residual_std() < residual_std()) *this = std::move(mult);
+}
+
+void HoltWinters::update(double value) {
+    if (n_obs == 0) return;
+    const double params[4] = {alpha, beta, gamma, phi};
+    const double yhat = step(params, value, level, trend, season, pos);
+    sse += (value - yhat) * (value - yhat);
+    n_errors++;
+    n_obs++;
+}
+
+double HoltWinters::deseasonalized_at(int h) const {
+    // 阻尼趋势累计：phi + phi^2 + ... + phi^h
+    double damp = 0.0, f = 1.0;
+    for (int i = 0; i < h; ++i) { f *= phi; damp += f; }
+    return level + damp * trend;
+}
+
+double HoltWinters::forecast_at(int h) const {
+    if (n_obs == 0) return 0.0;
+    h = std::max(h, 1);
+    double base = deseasonalized_at(h);
+    if (m == 0) return base;
+    double s = season[(pos + h - 1) % m];
+    return mode == Seasonality::Multiplicative ? base * s : base + s;
+}
+
+std::vector<double> HoltWinters::forecast(int steps) const {
+    std::vector<double> out;
+    for (int h = 1; h <= steps; ++h) out.push_back(forecast_at(h));
+    return out;
+}
+
+double HoltWinters::residual_std() const {
+    return n_errors ? std::sqrt(sse / n_errors) : 0.0;
+}
+
+std::vector<double> HoltWinters::residuals(const std::vector<double>& data) const {
+    std::vector<double> out;
+    if (n_obs == 0 || data.size() < 2 || (m > 0 && data.size() < 2 * static_cast<size_t>(m))) return out;
+    HoltWinters copy = *this;
+    copy.run(data, {alpha, beta, gamma, phi}, true);
+    for (size_t i = m > 0 ? m : 1; i < data.size(); ++i) out.push_back(data[i] - copy.fitted_values[i]);
+    return out;
+}
+
+nlohmann::json HoltWinters::to_json() const {
+    static const char* names[] = {"none", "additive", "multiplicative"};
+    nlohmann::json j;
+    j["seasonality"] = names[static_cast<int>(mode)];
+    j["period"] = m;
+    j["alpha"] = alpha;
+    j["beta"] = beta;
+    j["gamma"] = gamma;
+    j["phi"] = phi;
+    j["level"] = level;
+    j["trend"] = trend;
+    j["season"] = season;
+    j["observations"] = n_obs;
+    j["residual_std"] = residual_std();
+    return j;
+}
+
+nlohmann::json HoltWinters::state() const {
+    nlohmann::json j = to_json();
+    j["pos"] = pos;
+    j["sse"] = sse;
+    j["errors"] = n_errors;
+    return j;
+}
+
+bool HoltWinters::restore(const nlohmann::json& j) {
+    HoltWinters loaded;
+    try {
+        const std::string name = j.at("seasonality").get<std::string>();
+        loaded.mode = name == "multiplicative" ? Seasonality::Multiplicative
+                    : name == "additive" ? Seasonality::Additive : Seasonality::None;
+        loaded.m = j.at("period").get<int>();
+        loaded.alpha = j.at("alpha").get<double>();
+        loaded.beta = j.at("beta").get<double>();
+        loaded.gamma = j.at("gamma").get<double>();
+        loaded.phi = j.at("phi").get<double>();
+        loaded.level = j.at("level").get<double>();
+        loaded.trend = j.at("trend").get<double>();
+        loaded.season = j.at("season").get<std::vector<double>>();
+        loaded.pos = j.at("pos").get<size_t>();
+        loaded.n_obs = j.at("observations").get<size_t>();
+        loaded.sse = j.at("sse").get<double>();
+        loaded.n_errors = j.at("errors").get<size_t>();
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+    if (loaded.m < 0 || loaded.season.size() != static_cast<size_t>(loaded.m) ||
+        (loaded.m > 0 && loaded.pos >= static_cast<size_t>(loaded.m))) {
+        return false;
+    }
+    *this = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,73 @@
+#include "include/hyperloglog.h"
+#include <algorithm>
+#include <cmath>
+
+HyperLogLog::HyperLogLog(int precision) : p(std::clamp(precision, 4, 18)), registers(size_t(1) << p, 0) {}
+
+// FNV-1a 后接 splitmix64 混合，保证高低位都足够均匀
+uint64_t HyperLogLog::hash(const std::string& item) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : item) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+void HyperLogLog::add(const std::string& item) {
+    add_hash(hash(item));
+}
+
+void HyperLogLog::add_hash(uint64_t h) {
+    // 高 p 位选寄存器，其余位的前导零个数+1 为秩
+    size_t idx = static_cast<size_t>(h >> (64 - p));
+    uint64_t rest = (h << p) | (uint64_t(1) << (p - 1));
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > registers[idx]) registers[idx] = rank;
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.p != p) return false;
+    for (size_t i = 0; i < registers.size(); ++i) {
+        registers[i] = std::max(registers[i], other.registers[i]);
+    }
+    return true;
+}
+
+double HyperLogLog::estimate() const {
+    const double m = static_cast<double>(registers.size());
+    double alpha;
+    if (registers.size() == 16) alpha = 0.673;
+    else if (registers.size() == 32) alpha = 0.697;
+    else if (registers.size() == 64) alpha = 0.709;
+    else alpha = 0.7213 / (1.0 + 1.079 / m);
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t r : registers) {
+        sum += std::ldexp(1.0, -r);
+        if (r == 0) zeros++;
+    }
+    double e = alpha * m * m / sum;
+    // 小基数时改用线性计数
+    if (e <= 2.5 * m && zeros > 0) e = m * std::log(m / zeros);
+    return e;
+}
+
+double HyperLogLog::relative_error() const {
+    return 1.04 / std::sqrt(static_cast<double>(registers.size()));
+}
+
+nlohmann::json HyperLogLog::to_json() const {
+    double e = estimate();
+    double err = relative_error();
+    return {
+        {"estimate", std::round(e)},
+        {"relative_error", err},
+        {"ci95", {std::max(0.0, e * (1 - 1.96 * err)), e * (1 + 1.96 * err)}}
+    };
+}
@@ -21,6 +21,8 @@ struct AnalysisResult {
     double stddev_amount;
     std::map<std::string, double> category_total;
     std::vector<std::string> anomalies;
+    // 每条记录的异常得分（Isolation Forest，与输入记录一一对应）
+    std::vector<double> anomaly_scores;
 
 
     // 新增：多维聚类结果
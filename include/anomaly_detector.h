@@ -1,9 +1,55 @@
 _Pragma("once")
+#include <cstdint>
+#include <string>
 #include <vector>
 #include "record.h"
+#include "feature_matrix.h"
+
+// 局部离群因子 LOF（Breunig et al. 2000），data 为 n x dim 行优先矩阵。
+// kNN 由 KD 树并行查询一次，邻居表在 k-距离、局部可达密度、LOF 三轮计算中复用，整体约 O(n log n · k)。
+// 返回每行的 LOF：约 1 为与邻域密度相当，明显大于 1 为低密度离群点；重复点的可达距离以极小值兜底。
+std::vector<double> local_outlier_factor(const float* data, size_t n, size_t dim, size_t k = 20, unsigned threads = 0);
+
+// 分组检测结果：每组独立训练 Isolation Forest，得分只与本组记录比较
+struct GroupedAnomalies {
+    std::vector<size_t> indices;            // 被标记的记录，按组内得分降序
+    std::vector<double> scores;             // 每条记录在所属组森林上的得分
+    std::vector<uint32_t> group_of;         // 记录 -> 组编号
+    std::vector<std::string> group_names;   // 合并组的名字为空串
+    uint32_t pooled_group = UINT32_MAX;     // 过小的键合并成的剩余组编号，无则 UINT32_MAX
+    std::vector<size_t> group_sizes, group_flagged;
+    std::vector<double> group_thresholds;   // 各组 (1 - contamination) 分位数
+};
+
+// 日总额季节性异常：某日残差（扣除趋势、周、年季节后）的稳健 z 值超过阈值
+struct SeasonalAnomaly {
+    int day = 0;                  // 天序号（1970-01-01 为 0）
+    double total = 0.0;           // 当日总额
+    double expected = 0.0;        // 趋势 + 季节
+    double residual = 0.0;
+    double z = 0.0;               // (残差 - 中位数) / (1.4826 * MAD)
+    std::vector<size_t> records;  // 贡献超额部分的记录，按金额降序
+};
 
 class AnomalyDetector {
 public:
-    std::vector<size_t> detect(const std::vector<Record>& records, double contamination);
+    // Isolation Forest 异常检测：scores 非空时写入每条记录的异常得分（0~1，约 0.5 为正常）；
+    // 返回得分不低于 (1 - contamination) 分位数且大于 0.5 的记录下标，按得分降序
+    std::vector<size_t> detect(const std::vector<Record>& records, double contamination, std::vector<double>* scores = nullptr);
+    // 同上，直接使用已构建的特征矩阵（行与记录一一对应）
+    std::vector<size_t> detect(const FeatureMatrix& features, double contamination, std::vector<double>* scores = nullptr);
+    // 分组检测：按类别或商品（驻留为整数编号）划分记录，各组独立检测、按组内分位数标记后合并。
+    // 只用一份线程预算：占总量足以分得 2 个以上线程的大组逐个用满全部线程，其余组之间并行、组内单线程，
+    // 按记录数从大到小调度；少于 min_group 条的组合并检测（pooled_group）。
+    enum class GroupBy { Type, Product };
+    GroupedAnomalies detect_grouped(const std::vector<Record>& records, const FeatureMatrix& features, GroupBy by,
+                                    double contamination, size_t min_group = 32);
+    // 季节性检测：daily 为从 first_day 开始的逐日总额，按周（7）与年（365）做 MSTL 分解，
+    // 只标记高于预期的日期（支出尖峰），并把当日金额最大、合计覆盖超额部分的记录归因到该日；按 z 降序
+    std::vector<SeasonalAnomaly> detect_seasonal(const std::vector<Record>& records, const std::vector<double>& daily,
+                                                 int first_day, double z_threshold = 3.5);
+    // 基于密度的 LOF 检测：返回 LOF 不低于 (1 - contamination) 分位数且大于 LOF_THRESHOLD 的记录下标，按 LOF 降序
+    static constexpr double LOF_THRESHOLD = 1.5;
+    std::vector<size_t> detect_lof(const FeatureMatrix& features, double contamination, size_t k = 20,
+                                   std::vector<double>* scores = nullptr);
 };
-
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include "json.hpp"
+#include "kalman.h"
+
+// ARIMA(p,d,q)(P,D,Q)_s
+// 先做 d 次普通差分与 D 次季节差分，差分后序列（无差分时先去均值）按展开的乘积 ARMA 多项式
+// phi(B)Phi(B^s) w_t = theta(B)Theta(B^s) e_t 建立状态空间模型，用 Kalman 滤波计算精确似然（sigma^2 集中），
+// 有界 Nelder-Mead 在偏自相关变换后的参数空间上最大化似然，保证平稳与可逆。
+// 预测把差分并回 AR 多项式后递推，预测区间由 psi 权重给出：Var(h) = sigma^2 * sum_{j<h} psi_j^2。
+
+struct ArimaOrder {
+    int p = 1, d = 0, q = 0;
+    int P = 0, D = 0, Q = 0;
+    int s = 12;
+};
+
+class Arima {
+public:
+    // 拟合指定阶数，数据不足时返回 false
+    bool fit(const std::vector<double>& data, const ArimaOrder& order);
+    // 按差分后标准差是否下降决定 d、D（各至多 1），再在少量 (p,q)(P,Q) 组合中按 AICc 选阶
+    bool fit_auto(const std::vector<double>& data, int season = 12);
+
+    struct Forecast {
+        std::vector<double> mean;
+        std::vector<double> std_err;
+    };
+    Forecast forecast(int steps) const;
+
+    bool is_fitted() const { return fitted; }
+    const ArimaOrder& order() const { return ord; }
+    double aicc() const;
+    nlohmann::json to_json() const;
+
+private:
+    ArimaOrder ord;
+    bool fitted = false;
+    std::vector<double> ar, ma, sar, sma;       // 各因子系数
+    std::vector<double> phi_full, theta_full;   // 展开后的 ARMA 系数
+    double mean = 0.0;                          // 无差分时扣除的均值
+    double sigma2 = 0.0, neg2_loglik = 0.0;
+    size_t n_eff = 0;                           // 参与似然的差分后观测数
+    std::vector<double> history, innovations;   // 原序列与对齐的一步预测误差（差分丢失的前若干期为 0）
+    int n_params() const { return ord.p + ord.q + ord.P + ord.Q + (ord.d + ord.D == 0 ? 1 : 0); }
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "forecaster.h"
+#include "holt_winters.h"
+#include "json.hpp"
+
+// 滚动起点回测：对每条序列依次以第 t 个月为预测起点，只用 [0, t) 的历史拟合候选模型，
+// 预测 t..t+horizon-1 并与实际值比较。(序列, 候选) 任务互不依赖，并行执行，
+// 各任务写自己的累加器，最后按固定顺序归并，结果与线程数无关。
+
+// 候选预测器：history 为起点前的观测，first_month 为 history[0] 的 年*12+月-1；
+// 输出 horizon 步点预测 mean 与 95% 区间半宽 half_width
+struct ForecastCandidate {
+    std::string name;      // 模型族
+    nlohmann::json params; // 该候选的固定参数
+    std::function<void(const double* history, size_t n, int first_month, int horizon,
+                       std::vector<double>& mean, std::vector<double>& half_width)> forecast;
+};
+
+// 平滑组合族（原 complex_analysis 的做法）：本月 = alpha 指数平滑，下月 = 平滑值 + 0.5*最近变化再乘同月季节指数，
+// 与 phi1 的 AR(1) 预测按 weight : (1-weight) 组合；区间为历史 ±1σ
+ForecastCandidate smoothing_blend_candidate(double alpha, double phi1, double weight);
+// AR 族：order < 0 时按 BIC 在 0..min(6, n/2) 中定阶，区间由 psi 权重给出
+ForecastCandidate ar_candidate(int order);
+// Holt-Winters 族：不指定季节形式时自动在加法/乘法中择优
+ForecastCandidate holt_winters_candidate();
+ForecastCandidate holt_winters_candidate(HoltWinters::Seasonality seasonality);
+// 按 Holt-Winters 族候选的参数在 history 上拟合同一模型，供需要模型状态的场合（如自助法区间）；其他族返回 false
+bool fit_holt_winters_candidate(const ForecastCandidate& candidate, const std::vector<double>& history, HoltWinters& model);
+// ARIMA/SARIMA 族：季节周期 12，差分阶数与 ARMA 阶数自动选择，区间由 psi 权重给出；拟合失败时退化为末值预测
+ForecastCandidate arima_candidate();
+
+// 回测默认候选：legacy_blend（alpha=0.7, phi1=0.5, 五五组合）、BIC 定阶 AR(p)、自动 Holt-Winters
+std::vector<ForecastCandidate> default_candidates();
+
+struct BacktestOptions {
+    size_t min_train = 12;   // 首个起点前至少的历史月数
+    int horizon = 2;         // 本月 + 下月，对应 monthly_predict 的两个预测
+    size_t max_origins = 24; // 每条序列最多回放最近的多少个起点
+    unsigned threads = 0;    // 0 取硬件并发数
+};
+
+// 单个候选在某个预测步长上的误差汇总
+struct HorizonScore {
+    double mape = 0.0;     // 实际值为 0 的点不计入
+    double smape = 0.0;    // 预测与实际均为 0 的点不计入
+    double coverage = 0.0; // 实际值落入 95% 区间的比例
+    size_t forecasts = 0;
+};
+
+struct CandidateScore {
+    std::string name;
+    std::vector<HorizonScore> horizons; // horizons[h-1]
+    double fit_ms_total = 0.0;
+    double fit_ms_per_series = 0.0;
+    size_t series = 0;                  // 至少有一个起点的序列数
+};
+
+std::vector<CandidateScore> run_backtest(const SeriesMatrix& series, int first_month,
+                                         const std::vector<ForecastCandidate>& candidates,
+                                         const BacktestOptions& options = {});
+
+nlohmann::json backtest_to_json(const std::vector<CandidateScore>& scores, const BacktestOptions& options);
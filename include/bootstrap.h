@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "holt_winters.h"
+#include "json.hpp"
+
+// 块自助法（moving block bootstrap）预测区间
+// 从模型的样本内一步残差中按长度为 block 的连续块重抽样，作为未来扰动逐步喂给状态空间模型（Holt-Winters 的
+// forecast_at(1) + update），模拟大量未来路径，再取各步的分位数带。块保留残差的短期自相关。
+// 路径并行模拟；第 path 条路径第 b 个块的起点只由 counter_index(seed, path, b) 决定，结果与线程数无关。
+
+struct BootstrapOptions {
+    size_t paths = 2000;
+    size_t block = 0;     // 0 时取 max(1, round(n^(1/3)))
+    uint64_t seed = 42;
+    unsigned threads = 0; // 0 取硬件并发数
+    std::vector<double> quantiles = {0.05, 0.25, 0.5, 0.75, 0.95};
+};
+
+struct QuantileBands {
+    std::vector<double> probs;
+    std::vector<double> point;              // 模型自身的点预测 point[h-1]
+    std::vector<std::vector<double>> bands; // bands[k][h-1] 为第 k 个分位数
+    size_t paths = 0, block = 0;
+    // 分位数带相对点预测的偏移，叠加到其他点预测上
+    double offset(size_t k, size_t h) const { return bands[k][h] - point[h]; }
+    // 第 h 步（0 起）各分位数 (band + shift) * scale，截断到非负，键为 label(p)
+    nlohmann::json values_at(size_t h, double shift = 0.0, double scale = 1.0) const;
+    // "q5" / "q50" / "q95" 形式的标签
+    static std::string label(double p);
+};
+
+// residuals 为样本内一步残差（可用 HoltWinters::residuals 求得）；残差过少或模型未拟合时返回空带
+QuantileBands bootstrap_bands(const HoltWinters& model, const std::vector<double>& residuals,
+                              int horizon, const BootstrapOptions& options = {});
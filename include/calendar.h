@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "record.h"
+
+// 稠密日历：按月份序号（年*12+月-1）连续存放 [月][日] 金额，每月固定 31 个日槽，
+// 由记录的整数日期（time_tm）一次遍历构建，月份范围随遇到的记录向两端扩展，缺失月份为全 0
+
+class DenseCalendar {
+public:
+    // weights 非空时每条记录的金额乘以对应权重（抽样模式下为所在层的放大系数）
+    void build(const std::vector<Record>& records, const std::vector<double>* weights = nullptr);
+    void add(const tm& date, double amount);
+
+    bool empty() const { return months.empty(); }
+    int first_month() const { return first; }
+    int last_month() const { return first + static_cast<int>(months.size()) - 1; }
+    bool contains(int month_index) const { return !empty() && month_index >= first && month_index <= last_month(); }
+    // d 为 1..31；范围外返回 0
+    double day(int month_index, int d) const;
+    double month_total(int month_index) const;
+    const std::array<double, 31>& days_of(int month_index) const { return months[month_index - first].days; }
+
+    static int days_in_month(int month_index);
+
+private:
+    struct Month {
+        std::array<double, 31> days{};
+        double total = 0.0;
+    };
+    int first = 0;
+    std::vector<Month> months;
+};
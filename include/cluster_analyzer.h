@@ -1,14 +1,50 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <string>
 #include "record.h"
 #include "cluster_info.h"
+#include "feature_matrix.h"
+
+// Mini-batch k-means（Sculley 2010）：每批先按当前质心分配，再逐点以 1/该质心累计样本数 的学习率
+// 把质心拉向样本，内存只与批大小有关，可直接喂流式读取到的特征行。
+class MiniBatchKMeans {
+public:
+    MiniBatchKMeans(int k, size_t dim, uint64_t seed = 42);
+    // rows 为 count x dim 行优先（已标准化）；首次累计到至少 k 行时用 k-means++ 播种。
+    // 返回本批各质心平移量平方的均值（未播种时为 -1）
+    double partial_fit(const float* rows, size_t count);
+    bool initialized() const { return !center.empty(); }
+    const std::vector<float>& centers() const { return center; }
+    const std::vector<uint64_t>& counts() const { return count; }
+
+private:
+    int k;
+    size_t dim;
+    uint64_t seed;
+    std::vector<float> center;    // k x dim
+    std::vector<uint64_t> count;  // 各质心累计吸收的样本数
+    std::vector<float> pending;   // 播种前缓存的行
+};
 
 // 聚类分析器类
 class ClusterAnalyzer {
 public:
-    // 执行KMeans聚类
+    // 按金额的一维 k-means：排序后用 Ckmeans.1d.dp 动态规划求全局最优划分，结果确定；
+    // 返回的簇按质心从高到低排列，标签依次为 "Cluster 1".."Cluster k"
     std::vector<ClusterInfo> kmeans_cluster(const std::vector<Record>& records, int num_clusters);
+    // 多维 k-means（features 的行与 records 一一对应）：k-means++ 播种（计数器随机数，只由 seed 决定），
+    // 特征转为按列存放后用向量化内核算平方距离；分配按固定大小的块并行，每块各自累加质心和，
+    // 再按块序归并，结果与线程数无关。簇按平均金额从高到低排列，centroid 为标准化特征空间中的质心
+    std::vector<ClusterInfo> kmeans_cluster(const FeatureMatrix& features, const std::vector<Record>& records,
+                                            int num_clusters, uint64_t seed = 42, int max_iterations = 100,
+                                            unsigned threads = 0);
+    // 行数不少于该值时 kmeans_cluster(FeatureMatrix) 自动改用 mini-batch
+    static constexpr size_t MINI_BATCH_ROWS = 1000000;
+    // Mini-batch 版本：按计数器随机数有放回地抽取 batch_size 行为一批，质心平移的指数平均低于阈值或达到
+    // max_batches 后停止，最后对全部记录做一次并行最近质心分配得到 ClusterInfo
+    // （直接读行优先的 features、逐块转置，不再整体复制一份按列存放的特征）
+    std::vector<ClusterInfo> minibatch_kmeans_cluster(const FeatureMatrix& features, const std::vector<Record>& records,
+                                                      int num_clusters, uint64_t seed = 42, size_t batch_size = 4096,
+                                                      size_t max_batches = 500, unsigned threads = 0);
 };
-
-
@@ -8,6 +8,7 @@ struct ClusterInfo {
     std::vector<size_t> member_indices; // 指向原始记录的下标
     double cluster_total = 0.0;
     double avg_amount = 0.0;
+    std::vector<double> centroid;       // 多维聚类时为标准化特征空间中的质心，一维金额聚类时为空
     // 可扩展更多特征
 };
 
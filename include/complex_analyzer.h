@@ -8,8 +8,11 @@
 #include "anomaly_detector.h"
 #include "cluster_analyzer.h"
 #include "analysis_result.h"
+#include "forecast_analyzer.h"
 
-// 复杂分析主入口
-AnalysisResult complex_analysis(const std::vector<Record>& records, const I18N& i18n);
+// 复杂分析主入口，forecast_state 为预测模型状态文件（空则每次全量拟合）；
+// weights 为抽样模式下每条样本的放大系数，日序列、滑动窗口与预测据此按总体估计构建
+AnalysisResult complex_analysis(const std::vector<Record>& records, const I18N& i18n, const std::string& forecast_state = "",
+                                const std::vector<double>* weights = nullptr);
 
 
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+// 基于计数器的随机数：输出只由 (seed, stream, counter) 决定，与调用顺序和线程划分无关，
+// 并行任务各按自己的 (路径/树/样本, 步) 取数即可复现。混合函数为 splitmix64 终结器。
+
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+inline uint64_t counter_random(uint64_t seed, uint64_t stream, uint64_t counter) {
+    return splitmix64(splitmix64(seed ^ splitmix64(stream)) ^ counter);
+}
+
+// [0, 1) 均匀分布，取高 53 位
+inline double counter_uniform(uint64_t seed, uint64_t stream, uint64_t counter) {
+    return (counter_random(seed, stream, counter) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// [0, n) 均匀整数（乘法映射，n 远小于 2^64 时偏差可忽略）
+inline uint64_t counter_index(uint64_t seed, uint64_t stream, uint64_t counter, uint64_t n) {
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(counter_random(seed, stream, counter)) * n) >> 64);
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <functional>
 #include "record.h"
 
 std::vector<Record> parse_csv(const std::string& filename);
+// 流式解析：每解析出一条有效记录即回调一次，不在内存中保留全部记录
+bool parse_csv_stream(const std::string& filename, const std::function<void(Record&&)>& on_record);
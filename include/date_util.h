@@ -0,0 +1,52 @@
+#pragma once
+#include <ctime>
+#include <cstdio>
+#include <string>
+
+// 日期工具：公历年月日与整数天序号互转（1970-01-01 为第 0 天）
+// 纯整数运算，避免在热路径上反复格式化/解析日期字符串
+
+inline int days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+inline void civil_from_days(int z, int& y, int& m, int& d) {
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = static_cast<int>(yoe) + era * 400 + (m <= 2);
+}
+
+// 解析失败的记录 time_tm 为全零，不参与按日期的聚合
+inline bool valid_date(const tm& t) {
+    return t.tm_year >= 70 && t.tm_mday >= 1;
+}
+
+inline int day_index(const tm& t) {
+    return days_from_civil(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday);
+}
+
+inline std::string format_day(int z) {
+    int y, m, d;
+    civil_from_days(z, y, m, d);
+    char buf[32]; // 按 int 最大宽度留足空间，编译器无法推断 m/d 的取值范围
+    snprintf(buf, sizeof(buf), "%04d-%02d-%02d", y % 10000, m, d);
+    return buf;
+}
+
+// 月序号（年*12+月-1）格式化为 "YYYY-MM"
+inline std::string format_month(int index) {
+    char buf[32]; // 同 format_day
+    snprintf(buf, sizeof(buf), "%04d-%02d", index / 12 % 10000, index % 12 + 1);
+    return buf;
+}
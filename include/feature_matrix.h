@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "record.h"
+
+// 记录级特征矩阵：每条记录一行，行优先连续 float 存放，供异常检测与聚类共享，
+// 特征只从 Record 推导一次。
+// 金额、单价、数量先做带符号 log1p 压缩长尾；随后每列按均值/标准差标准化（常数列只去均值）。
+// 日期无效的记录星期列取均值（标准化后为 0）。
+
+struct FeatureMatrix {
+    enum Column { Amount, UnitPrice, Quantity, Weekday, CategoryZ, ProductFrequency, ColumnCount };
+    static const char* const column_names[ColumnCount];
+
+    size_t rows = 0;
+    size_t dim = ColumnCount;
+    std::vector<float> values;            // rows x dim
+    std::vector<double> mean, scale;      // 各列标准化参数：x = (raw - mean) / scale
+
+    const float* data() const { return values.data(); }
+    const float* row(size_t i) const { return values.data() + i * dim; }
+    float at(size_t i, Column c) const { return values[i * dim + c]; }
+};
+
+FeatureMatrix build_feature_matrix(const std::vector<Record>& records);
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <string>
+#include "record.h"
+#include "analysis_result.h"
+#include "stats.h"
+#include "forecaster.h"
+#include "heavy_hitters.h"
+
+// 月度/每日消费预测，结果写入 result.extra_json 的 monthly_predict / daily_predict。
+// state_path 非空时从该文件续接上次的模型状态，新增观测只做增量更新，结束后写回；
+// weights 非空时（抽样模式）日/月序列按每条记录的放大系数加权，即总体序列的估计
+void forecast_analysis(const std::vector<Record>& records, AnalysisResult& result, const std::string& state_path = "",
+                       const std::vector<double>* weights = nullptr);
+
+// 分组月度序列：matrix 每行一条序列，groups[i] 为该行所属分组（total/category/product/country）。
+// 月份轴取日期有效的记录中除当前自然月外的首末月份，缺失月份为 0
+struct GroupedSeries {
+    SeriesMatrix matrix;
+    std::vector<std::string> groups;
+    int first_month = 0;   // 第 0 列对应的 年*12+月-1
+    int current_month = 0; // 当前自然月（未结束，已排除）
+};
+
+// 按 compute_stats 的分组（总额、全部类别、国家）及 product_spend 摘要中消费额前 top_products 的商品
+// 一次遍历构建序列矩阵；weights 同 forecast_analysis
+GroupedSeries build_grouped_series(const std::vector<Record>& records,
+                                   const std::map<std::string, TypeStats>& type_stats,
+                                   const std::map<std::string, CountryStats>& country_stats,
+                                   const SpaceSaving& product_spend,
+                                   const std::vector<double>* weights = nullptr,
+                                   size_t top_products = 50);
+
+// 批量预测：对 build_grouped_series 的每条序列并行拟合 AR(p)，写入 result.extra_json["forecasts"]
+void batch_forecast_analysis(const GroupedSeries& series, AnalysisResult& result);
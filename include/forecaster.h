@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "json.hpp"
+
+// 自回归 AR(p) 时序预测
+// 自协方差一次遍历求出 0..p 阶，再用 Levinson-Durbin 递推在 O(p^2) 内解 Yule-Walker 方程；
+// 递推过程同时给出 1..p 各阶的残差方差，可直接按 AIC/BIC 定阶。
+// 模型只保存充分统计量（观测数、总和、0..p 阶滞后交叉积和、首尾各 p 个观测），
+// 新观测以 O(p) 增量更新后重解，与序列长度无关；统计量可序列化到磁盘续用
+
+// 批量序列矩阵：每行一条等长序列（行优先连续存储），names[i] 为第 i 行的名称
+struct SeriesMatrix {
+    std::vector<std::string> names;
+    size_t length = 0;
+    std::vector<double> values;
+
+    SeriesMatrix() = default;
+    SeriesMatrix(std::vector<std::string> row_names, size_t len)
+        : names(std::move(row_names)), length(len), values(names.size() * len, 0.0) {}
+    size_t rows() const { return names.size(); }
+    double* row(size_t i) { return values.data() + i * length; }
+    const double* row(size_t i) const { return values.data() + i * length; }
+};
+
+class TimeSeriesForecaster {
+public:
+    enum class Criterion { AIC, BIC };
+    // 训练AR模型，order为阶数（含截距）
+    void fit(const std::vector<double>& data, int order = 1);
+    // 在 0..max_order 中按信息准则自动选阶
+    void fit_auto(const std::vector<double>& data, int max_order, Criterion criterion = Criterion::AIC);
+    // 批量拟合：矩阵每行独立自动定阶，多线程并行；threads 为 0 时取硬件并发数
+    static std::vector<TimeSeriesForecaster> fit_batch(const SeriesMatrix& series, int max_order,
+                                                       Criterion criterion = Criterion::AIC, unsigned threads = 0);
+    // 追加一个新观测并重新求解（阶数上限与定阶准则沿用上次拟合）
+    void update(double value);
+    // 预测未来n步
+    std::vector<double> predict(int steps) const;
+    int order() const { return ar_order; }
+    const std::vector<double>& coefficients() const { return ar_coeffs; }
+    double residual_variance() const { return sigma2; }
+    // 导出模型参数为JSON
+    nlohmann::json to_json() const;
+    // 增量状态的序列化/恢复，restore 在格式不符时返回 false 且不修改模型
+    nlohmann::json state() const;
+    bool restore(const nlohmann::json& j);
+private:
+    int ar_order = 1;
+    double mean = 0.0;
+    double intercept = 0.0;
+    double sigma2 = 0.0;
+    std::vector<double> ar_coeffs; // AR系数 phi_1..phi_p
+    std::vector<double> ic_values; // 自动定阶时各阶的信息准则值
+    // 充分统计量
+    int max_lag = 0;
+    bool select_order = false;
+    Criterion criterion = Criterion::AIC;
+    size_t n_obs = 0;
+    double total = 0.0;
+    std::vector<double> cross;     // cross[k] = sum_t x_t * x_{t-k}
+    std::vector<double> head;      // 最早 max_lag 个观测
+    std::vector<double> history;   // 最近 max(max_lag,1) 个观测，亦用于递推预测
+    void reset(int lag, bool select, Criterion crit);
+    void accumulate(double value);
+    void solve();
+};
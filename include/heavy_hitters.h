@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "record.h"
+#include "json.hpp"
+
+// Space-Saving 高频项（heavy hitters）统计
+// 最多保留 capacity 个计数器，内存与不同键的个数无关；
+// 计数器按最小堆组织，新键替换当前最小计数器，单次更新 O(log capacity)。
+// 每个计数的高估量不超过 error，真实值落在 [count - error, count] 内。
+
+class SpaceSaving {
+public:
+    struct Entry {
+        std::string key;
+        double count = 0.0; // 频次或金额（按权重累计）
+        double error = 0.0; // 替换时继承的最大高估量
+    };
+    explicit SpaceSaving(size_t capacity = 256);
+    void add(const std::string& key, double weight = 1.0);
+    // 合并另一线程/分区的摘要，结果仍最多保留 capacity 个计数器
+    void merge(const SpaceSaving& other);
+    // 按计数降序返回前 n 项
+    std::vector<Entry> top(size_t n) const;
+    // 未被跟踪键的计数上界
+    double min_count() const;
+    nlohmann::json to_json(size_t n) const;
+private:
+    size_t cap;
+    std::vector<Entry> heap; // 按 count 的最小堆
+    std::unordered_map<std::string, size_t> pos; // 键 -> 堆下标
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+    void swap_nodes(size_t a, size_t b);
+};
+
+// 产品/备注/原产国三个维度，分别按频次与金额排名
+struct HeavyHitterStats {
+    explicit HeavyHitterStats(size_t capacity = 256);
+    SpaceSaving product_freq, product_spend;
+    SpaceSaving remark_freq, remark_spend;
+    SpaceSaving country_freq, country_spend;
+    void add(const Record& r);
+    void merge(const HeavyHitterStats& other);
+    nlohmann::json to_json(size_t k = 10) const;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "json.hpp"
+
+// Holt-Winters 三参数指数平滑（水平、阻尼趋势、季节）
+// 单次滤波 O(n)，平滑参数 alpha/beta/gamma/phi 由有界 Nelder-Mead 最小化一步预测误差平方和得到。
+// 数据不足两个完整季节周期时退化为无季节的 Holt 阻尼趋势模型。
+// 拟合后的状态（水平/趋势/季节因子）可逐点 O(1) 更新，并可序列化到磁盘续用。
+
+class HoltWinters {
+public:
+    enum class Seasonality { None, Additive, Multiplicative };
+    // period 为季节长度（月度 12，每日 7）
+    void fit(const std::vector<double>& data, int period, Seasonality seasonality);
+    // 分别拟合加法与乘法季节（数据非正时只用加法），取误差更小者
+    void fit_auto(const std::vector<double>& data, int period);
+    // 以当前平滑参数追加一个观测，O(1)；不重新优化参数
+    void update(double value);
+    // 最后一个观测之后第 h 步（h>=1）的预测
+    double forecast_at(int h) const;
+    std::vector<double> forecast(int steps) const;
+    // 第 h 步预测的去季节部分（水平+阻尼趋势）
+    double deseasonalized_at(int h) const;
+    // 样本内一步预测值，fitted()[t] 对应 data[t]
+    const std::vector<double>& fitted() const { return fitted_values; }
+    double residual_std() const;
+    // 以当前参数对 data 重新滤波（O(n)，不改变模型），返回初始化期之后的样本内一步残差
+    std::vector<double> residuals(const std::vector<double>& data) const;
+    bool is_fitted() const { return n_obs > 0; }
+    nlohmann::json to_json() const;
+    // 滤波状态的序列化/恢复（不含样本内拟合值），restore 在格式不符时返回 false
+    nlohmann::json state() const;
+    bool restore(const nlohmann::json& j);
+    size_t observations() const { return n_obs; }
+
+private:
+    Seasonality mode = Seasonality::None;
+    int m = 0;          // 季节长度，无季节时为 0
+    double alpha = 0.5, beta = 0.1, gamma = 0.1, phi = 0.98;
+    double level = 0.0, trend = 0.0;
+    std::vector<double> season; // 季节因子，season[pos] 对应下一个观测
+    size_t pos = 0;
+    size_t n_obs = 0;
+    double sse = 0.0;
+    size_t n_errors = 0;
+    std::vector<double> fitted_values;
+    // 单步滤波：用观测 y 更新 l/t/s[p]，返回该点的一步预测值
+    double step(const double* params, double y, double& l, double& t, std::vector<double>& s, size_t& p) const;
+    // 以给定参数对 data 滤波，返回一步预测 SSE；keep 为真时保存最终状态与拟合值
+    double run(const std::vector<double>& data, const std::vector<double>& params, bool keep);
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "json.hpp"
+
+// HyperLogLog 基数估计
+// 每个草图固定 2^precision 个 1 字节寄存器，与去重元素个数无关；
+// 同精度的草图可逐寄存器取最大值合并，适合分区/多线程分别统计后汇总
+
+class HyperLogLog {
+public:
+    explicit HyperLogLog(int precision = 12);
+    void add(const std::string& item);
+    void add_hash(uint64_t h);
+    // 合并另一个草图，精度不同时返回 false 且不做修改
+    bool merge(const HyperLogLog& other);
+    double estimate() const;
+    // 标准误差 1.04/sqrt(m)
+    double relative_error() const;
+    int precision() const { return p; }
+    // 导出 {"estimate", "relative_error", "ci95": [low, high]}
+    nlohmann::json to_json() const;
+    static uint64_t hash(const std::string& item);
+private:
+    int p;
+    std::vector<uint8_t> registers;
+};
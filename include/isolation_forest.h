@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Isolation Forest（Liu et al. 2008）
+// 每棵树在不放回子样本上随机选特征、随机选切分点递归划分，深度上限 ceil(log2(sample_size))；
+// 异常点更早被隔离、路径更短，得分 s(x) = 2^(-E[h(x)] / c(sample_size))，越接近 1 越异常，约 0.5 为正常。
+// 树并行构建，建好后按树序拼接到一个连续的扁平节点数组，打分时只做顺序下标跳转，缓存友好；
+// 第 t 棵树的随机数只由 (seed, t, 计数器) 决定，结果与线程数无关。
+
+class IsolationForest {
+public:
+    explicit IsolationForest(size_t n_trees = 100, size_t sample_size = 256, uint64_t seed = 42);
+    // data 为 n x dim 行优先矩阵
+    void fit(const float* data, size_t n, size_t dim, unsigned threads = 0);
+    // 批量打分，返回每行的异常得分
+    std::vector<double> score(const float* data, size_t n, unsigned threads = 0) const;
+    bool is_fitted() const { return !roots.empty(); }
+
+private:
+    // 内部节点：feature >= 0，value 为切分点，左子为 left、右子为 left + 1；
+    // 叶节点：feature = -1，value 为剩余样本数对应的路径长度修正 c(size)
+    struct Node {
+        float value;
+        int32_t feature;
+        int32_t left;
+    };
+    size_t n_trees, sample_size;
+    uint64_t seed;
+    size_t dim = 0;
+    double norm = 1.0;           // c(实际子样本大小)
+    std::vector<Node> nodes;     // 所有树的节点连续存放
+    std::vector<int32_t> roots;  // 各树根节点下标
+};
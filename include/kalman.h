@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// ARMA(p,q) 的状态空间形式（Harvey 表示）上的精确似然 Kalman 滤波
+// 状态维度 r = max(p, q+1)：转移阵 T 第一列为 AR 系数、上次对角为 1，扰动载荷 R = (1, theta_1..theta_{r-1})，观测取状态第一分量。
+// 初始协方差取平稳解 P = T P T' + R R'（倍增法求解）。
+// 所有状态、协方差与临时矩阵在 resize 时一次分配，filter 的逐步递推不再分配内存；
+// 利用 T 的稀疏结构，每步预测为 O(r^2)。
+
+class KalmanWorkspace {
+public:
+    // 为给定 AR/MA 阶数准备工作区（阶数不变时重复调用不会重新分配）
+    void resize(int ar_order, int ma_order);
+    int state_dim() const { return r; }
+
+    struct Result {
+        double sum_sq = 0.0;     // sum v_t^2 / F_t（sigma^2 = 1 标度）
+        double sum_log_f = 0.0;  // sum log F_t
+        size_t n = 0;
+        // sigma^2 集中后的 -2 log L
+        double neg2_loglik() const;
+        double sigma2() const { return n ? sum_sq / n : 0.0; }
+    };
+
+    // 对序列 w 滤波；innovations 非空时写入每步一步预测误差 v_t（长度 n）
+    Result filter(const double* w, size_t n, const double* phi, const double* theta, double* innovations = nullptr);
+
+private:
+    int r = 0, p = 0, q = 0;
+    std::vector<double> a, a_tmp;         // 状态均值
+    std::vector<double> P, TP, A, AP, RR; // 协方差与临时矩阵（行优先 r*r）
+    std::vector<double> tcol, rvec;       // T 第一列、R
+    void stationary_covariance();
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// KD 树 kNN 索引（欧氏距离）
+// 构建：每个节点在跨度最大的维度上取中位数切分（nth_element），叶节点至多 leaf_size 个点，整体 O(n log n)；
+// 节点与点都存放在扁平数组中：构建后按树内顺序复制一份坐标，叶内的点连续存放，查询时顺序扫描。
+// 每个节点保存包围盒，查询时先进入距离更近的子节点，包围盒到查询点的距离超过当前第 k 近距离时剪枝；
+// 批量查询按树内顺序进行，相邻查询访问的节点与点高度重合，缓存友好。
+// 距离相同的邻居按下标排序，结果确定，与线程数无关。
+// 大量重合的点（同一商品同一价格的重复记录）放在同一个叶中按行号排好，查询时各点到查询点的距离相同，
+// 只需从头取到第 k 近即停，不随重合点数增长。
+
+class KdTree {
+public:
+    explicit KdTree(size_t leaf_size = 32) : leaf_size(leaf_size) {}
+    // data 为 n x dim 行优先矩阵，需在树的生命周期内保持有效
+    void build(const float* data, size_t n, size_t dim);
+    // 查询第 i 个点（自身除外）的 k 个最近邻，按距离升序写入 idx/dist2（平方距离），返回实际个数
+    size_t query_point(size_t i, size_t k, uint32_t* idx, float* dist2) const;
+    // 批量 kNN：所有点的邻居表，idx/dist2 为 n x k 行优先（不足 k 个时补 UINT32_MAX / inf），并行查询
+    void all_knn(size_t k, std::vector<uint32_t>& idx, std::vector<float>& dist2, unsigned threads = 0) const;
+    size_t size() const { return n; }
+
+private:
+    // 内部节点：split_dim >= 0，左右子为 left / left + 1；叶节点：split_dim = -1，点为 perm[begin, end)；
+    // 坐标全部重合的区间不再切分，整体作为一个叶（split_dim = COINCIDENT），点按行号升序存放
+    static constexpr int32_t COINCIDENT = -2;
+    struct Node {
+        float split;
+        int32_t split_dim;
+        uint32_t left;
+        uint32_t begin, end;
+    };
+    size_t leaf_size;
+    const float* data = nullptr;
+    size_t n = 0, dim = 0;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> perm;  // 树内位置 -> 原始行号
+    std::vector<float> points;   // 按树内顺序排列的坐标
+    std::vector<float> boxes;    // 每节点 2 x dim：[lo..., hi...]
+    void build_node(uint32_t node, uint32_t begin, uint32_t end);
+    float box_distance(uint32_t node, const float* q) const;
+};
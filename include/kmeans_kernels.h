@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "record.h"
+#include "cluster_info.h"
+#include "feature_matrix.h"
+
+// Lloyd 与 mini-batch k-means 共用的内核：按列存放的特征、分块最近质心分配、k-means++ 播种与结果汇总
+
+namespace kmeans {
+
+constexpr size_t BLOCK = 1024;
+
+// 按列存放的特征：col(d)[i] 为第 i 行第 d 维
+struct Columns {
+    size_t n = 0, dim = 0;
+    std::vector<float> data;
+    Columns() = default;
+    explicit Columns(const FeatureMatrix& fm);
+    // rows 为 count x dim 行优先
+    Columns(const float* rows, size_t count, size_t dim);
+    // 以 rows 重新填充，沿用已有容量
+    void assign(const float* rows, size_t count, size_t dim);
+    const float* col(size_t d) const { return data.data() + d * n; }
+};
+
+// 块 [begin, end) 内的最近质心：best/label 以块内偏移写入；同距离取编号小者；dist 为工作缓冲
+void block_assign(const Columns& x, size_t begin, size_t end, const std::vector<float>& centers, int k,
+                  float* best, uint32_t* label, std::vector<float>& dist);
+// 全量并行分配（按 BLOCK 分块），返回每行所属质心
+std::vector<uint32_t> assign_all(const Columns& x, const std::vector<float>& centers, int k, unsigned threads);
+// 同上，但直接读行优先的特征：每块转置到各线程复用的 BLOCK 大小缓冲，不整体复制特征矩阵
+std::vector<uint32_t> assign_rows(const FeatureMatrix& fm, const std::vector<float>& centers, int k, unsigned threads);
+// k-means++：每个新质心按到已选质心最小平方距离的比例抽样，只由 seed 决定
+std::vector<float> plus_plus(const Columns& x, int k, uint64_t seed, unsigned threads);
+// 汇总为 ClusterInfo，按平均金额从高到低编号为 "Cluster 1".."Cluster k"
+std::vector<ClusterInfo> make_clusters(const std::vector<uint32_t>& label, const std::vector<float>& centers, int k,
+                                       size_t dim, const std::vector<Record>& records);
+
+}
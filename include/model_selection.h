@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include "backtest.h"
+#include "json.hpp"
+
+// 逐序列自动选模：在保留尾段上对参数网格中的每个候选做滚动起点评估（训练只用起点之前的数据），
+// 以 horizon 步内的平均 sMAPE 评分。候选并行评估；某候选的累计误差一旦超过已完成候选的最好总误差即剪枝
+// （误差非负，剪掉的候选不可能胜出，因此胜出者与评分与线程数和调度顺序无关；
+// 哪些候选被剪枝取决于完成先后，不对外输出）。
+// 选择结果可随预测状态持久化：模型续接时直接恢复胜出者，只在全量重拟合时重新选模。
+
+struct ModelSelection {
+    bool selected = false;
+    ForecastCandidate model; // 胜出候选
+    size_t index = 0;        // 胜出候选在网格中的位置
+    double score = 0.0;      // 保留尾段上的平均 sMAPE（%）
+    size_t tail = 0;         // 保留尾段长度
+    nlohmann::json to_json() const;
+    // 持久化：记录网格位置与参数；恢复时网格中对应候选的族与参数须一致，否则返回 false
+    nlohmann::json state() const;
+    bool restore(const nlohmann::json& j, const std::vector<ForecastCandidate>& grid);
+};
+
+// 参数网格：平滑组合（alpha×phi1×组合权重）、固定阶与 BIC 定阶 AR、三种季节形式的 Holt-Winters、自动定阶 SARIMA
+std::vector<ForecastCandidate> candidate_grid();
+
+// series 为按月等间隔的历史，first_month 为 series[0] 的 年*12+月-1；数据过短时 selected 为 false
+ModelSelection select_model(const std::vector<double>& series, int first_month,
+                            const std::vector<ForecastCandidate>& grid, int horizon = 2, unsigned threads = 0);
@@ -0,0 +1,19 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+// 带边界约束的 Nelder-Mead 单纯形优化（无需梯度）
+// 每个试探点都投影回 [lower, upper] 盒约束内，适合平滑参数这类低维有界问题
+
+struct OptimizeResult {
+    std::vector<double> x;
+    double value = 0.0;
+    int evaluations = 0;
+};
+
+OptimizeResult nelder_mead_bounded(const std::function<double(const std::vector<double>&)>& objective,
+                                   std::vector<double> start,
+                                   const std::vector<double>& lower,
+                                   const std::vector<double>& upper,
+                                   int max_evaluations = 300,
+                                   double tolerance = 1e-6);
@@ -0,0 +1,36 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// 轻量并行循环：固定数量的 std::thread 通过原子计数器动态领取下标，
+// 适合代价不均的独立任务（如逐条序列拟合）。fn(i) 之间不得共享可写状态。
+
+inline unsigned default_thread_count() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+template <typename Fn>
+void parallel_for(size_t n, Fn&& fn, unsigned threads = 0) {
+    if (threads == 0) threads = default_thread_count();
+    threads = static_cast<unsigned>(std::min<size_t>(threads, n));
+    if (threads <= 1) {
+        for (size_t i = 0; i < n; ++i) fn(i);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < n;
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            fn(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker(); // 当前线程也参与
+    for (auto& th : pool) th.join();
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <vector>
+
+// 多分位数计算服务
+// 基于 nth_element 的部分选择：一次调用同时求多个分位数（如 p25/p50/p75/p95），
+// 总代价约 O(n·log q)，无需完整排序，也不做额外拷贝
+
+// 常用分位点
+inline const std::vector<double> DEFAULT_QUANTILES = {0.25, 0.5, 0.75, 0.95};
+
+// 在 data 上原地选择（会打乱 data 的元素顺序），按线性插值返回各分位数
+// ps 中每个值取 [0,1]，越界会被截断；返回值与 ps 一一对应，data 为空时全部返回 0
+std::vector<double> select_quantiles(std::vector<double>& data, const std::vector<double>& ps);
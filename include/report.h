@@ -7,4 +7,5 @@
 
 // 新增国际化版本
 #include "i18n.h"
-void generate_report_i18n(const std::vector<Record>& records, const Stats& global_stats, const std::map<std::string, Stats>& type_stats, const std::map<std::string, Stats>& product_stats, const std::map<std::string, Stats>& country_stats, const std::map<std::string, Stats>& monthly_stats, const std::map<std::string, Stats>& unit_price_stats, const I18N& i18n, const std::string& filename = "report.txt");
+// weights 非空时（抽样模式）逐条记录的计数/金额按其放大系数加权，与已放大的汇总统计口径一致
+void generate_report_i18n(const std::vector<Record>& records, const Stats& global_stats, const std::map<std::string, TypeStats>& type_stats, const std::map<std::string, CountryStats>& country_stats, const std::map<std::string, MonthlyStats>& monthly_stats, const I18N& i18n, const std::string& filename = "report.txt", const std::vector<double>* weights = nullptr);
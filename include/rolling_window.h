@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <map>
+#include "record.h"
+#include "json.hpp"
+
+// 滑动窗口统计引擎（7/30/90 日移动指标）
+// 对连续日序列一次遍历，同时维护多个窗口：
+// 和/平方和为 O(1) 增量更新，最小/最大值用单调双端队列，均摊 O(1)
+
+struct RollingPoint {
+    double sum = 0.0;
+    double mean = 0.0;
+    double std_dev = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// 连续日序列：values[i] 对应第 first_day + i 天（date_util.h 中的天序号），缺失日为 0
+struct DailySeries {
+    int first_day = 0;
+    std::vector<double> values;
+};
+
+class RollingWindowEngine {
+public:
+    explicit RollingWindowEngine(std::vector<int> windows = {7, 30, 90});
+    // 返回 out[w][t]：第 w 个窗口在以第 t 天结尾时的统计；窗口未填满的前 windows[w]-1 天不输出
+    std::vector<std::vector<RollingPoint>> compute(const std::vector<double>& series) const;
+    // 导出为 {"7": {"start_date", "sum", "mean", "std", "min", "max"}, ...}
+    nlohmann::json to_json(const DailySeries& series) const;
+    const std::vector<int>& windows() const { return window_sizes; }
+private:
+    std::vector<int> window_sizes;
+};
+
+// 一次遍历构建总体及各类别的日消费序列（所有序列共用同一日期范围）；weights 同 DenseCalendar::build
+void build_daily_series(const std::vector<Record>& records, DailySeries& total, std::map<std::string, DailySeries>& by_category,
+                        const std::vector<double>* weights = nullptr);
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "record.h"
+#include "stats.h"
+#include "analysis_result.h"
+#include "forecast_analyzer.h"
+#include "json.hpp"
+
+// 近似分析模式：按 类别×月份 分层的水塘抽样
+// 解析时逐条 offer，每层最多保留 per_stratum 条记录（至少 2 条才能估计层内方差，由调用方校验）；
+// 分析在样本上进行，再用分层 Horvitz-Thompson 估计把总额放大回总体，并给出 95% 置信区间；
+// 日/月序列由样本按所在层的放大系数加权构建，每日总额与分组月度序列的每个格子同样给出区间
+
+class StratifiedSampler {
+public:
+    explicit StratifiedSampler(size_t per_stratum = 200, uint64_t seed = 42);
+    // 解析阶段逐条调用（水塘抽样 Algorithm R）
+    void offer(Record&& record);
+    // 按时间排序的样本，供 complex_analysis / compute_stats 使用；
+    // weights 非空时同时输出每条样本的放大系数（所在层 总体条数/样本条数），与样本一一对应
+    std::vector<Record> sample(std::vector<double>* weights = nullptr) const;
+    size_t population() const { return population_size; }
+    size_t sample_size() const;
+    // 将样本上的统计结果放大为总体估计，并把各估计量的置信区间写入 result.extra_json["sampling"]；
+    // series 非空时（按同一组放大系数加权构建）逐格给出区间。由加权序列得出的字段列在 sampling.weighted，
+    // 未放大、直接基于样本计算的字段列在 sampling.sample_based
+    void apply(AnalysisResult& result, std::map<std::string, TypeStats>& type_stats, std::map<std::string, CountryStats>& country_stats,
+               std::map<std::string, MonthlyStats>& monthly_stats, Stats& global_stats, const GroupedSeries* series = nullptr) const;
+
+    // 总额估计：estimate ± 1.96*std_error
+    struct Estimate {
+        double total = 0.0;
+        double variance = 0.0;
+        size_t population = 0;
+        size_t sample = 0;
+    };
+    Estimate estimate_total() const;
+    std::map<std::string, Estimate> estimate_by_type() const;
+    std::map<std::string, Estimate> estimate_by_month() const;
+private:
+    struct Stratum {
+        std::string type;
+        std::string month;
+        size_t seen = 0;
+        std::vector<Record> reservoir;
+    };
+    size_t capacity;
+    size_t population_size = 0;
+    std::mt19937_64 rng;
+    std::unordered_map<std::string, Stratum> strata;
+    void accumulate(const Stratum& s, Estimate& e) const;
+    double expansion(const Stratum& s) const;
+    // 域总额（如某一天、某类别某月）：domains_of(r, ids) 写入样本 r 所属的域编号（< count）。
+    // 各层内以 z = 金额·1[属于该域] 为变量，估计量与方差同 accumulate；population 为域内条数的估计
+    template <typename DomainsOf>
+    std::vector<Estimate> estimate_domains(size_t count, DomainsOf domains_of) const;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// 金额列的向量化归约内核
+// 运行时按 CPU 能力选择 AVX-512 / AVX2 / SSE2 实现（非 x86 平台退回标量版本），
+// 输入为连续的 double 数组；带掩码的版本由过滤位图驱动（第 i 位为 1 表示第 i 个元素参与）
+
+namespace simd {
+
+struct Reduction {
+    double sum = 0.0;
+    double sumsq = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    size_t count = 0;
+};
+
+// 过滤位图：每 64 个元素一个字
+using Bitmap = std::vector<uint64_t>;
+
+template <typename Pred>
+Bitmap make_bitmap(size_t n, Pred pred) {
+    Bitmap bits((n + 63) / 64, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (pred(i)) bits[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+    return bits;
+}
+
+// 一次遍历同时求 和/平方和/最小/最大
+Reduction reduce(const double* data, size_t n);
+Reduction reduce_masked(const double* data, const uint64_t* bitmap, size_t n);
+// Σ(x - center)^2，用于数值稳定的方差计算
+double sum_sq_dev(const double* data, size_t n, double center);
+// 等宽直方图：[lo, hi] 分 bins 段，越界值计入首/末段
+std::vector<uint64_t> histogram(const double* data, size_t n, double lo, double hi, size_t bins);
+// 按列（SoA）的平方距离累加：acc[i] += (column[i] - center)^2，float 精度；
+// 各指令集版本都只用乘加两步（不做 FMA 融合），结果与标量版本逐位一致
+void squared_distance_accumulate(const float* column, size_t n, float center, float* acc);
+// 运行时检测一次的指令集档位，所有内核（含 simd_distance.cpp）按它分派；Avx2 档要求 AVX2 + FMA
+enum class Isa { Scalar, Sse2, Avx2, Avx512 };
+Isa isa();
+// 当前使用的指令集名称（"avx512" / "avx2" / "sse2" / "scalar"）
+const char* active_isa();
+
+}
@@ -2,36 +2,86 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <cmath>
+#include <type_traits>
 #include "record.h"
 #include "json.hpp" // nlohmann/json 头文件相对路径修正
+#include "hyperloglog.h"
+#include "simd_kernels.h"
 
-// 简单自回归(AR)时序预测
-// 用于预测未来n步消费趋势
-
-class TimeSeriesForecaster {
-public:
-    // 训练AR模型，order为阶数
-    void fit(const std::vector<double>& data, int order = 1);
-    // 预测未来n步
-    std::vector<double> predict(int steps) const;
-    // 导出模型参数和预测结果为JSON
-    nlohmann::json to_json() const;
-private:
-    int ar_order = 1;
-    std::vector<double> ar_coeffs; // AR系数
-    std::vector<double> train_data;
-};
-struct Stats {
+// 统计指标策略：每个策略只维护自己需要的状态与单条更新逻辑，
+// BasicStats<...> 只组合声明过的策略，未声明的指标不占内存也不做计算
+namespace metric {
+struct Sum {
     double total = 0.0;
-    double avg = 0.0;
+    void add(double value) { total += value; }
+};
+struct Count {
     int count = 0;
+    void add(double) { count++; }
+};
+struct MinMax {
     double min = 1e9;
     double max = 0.0;
+    void add(double value) {
+        if (value < min) min = value;
+        if (value > max) max = value;
+    }
+};
+// 保留原始值，用于中位数/分位数
+struct Quantile {
     std::vector<double> values;
-    void add_value(double value);
-    double median() const;
-    double std_dev() const;
-    bool operator<(const Stats& other) const;
+    void add(double value) { values.push_back(value); }
+    // 一次调用求多个分位数（ps 取 [0,1]），只拷贝一次 values
+    std::vector<double> quantiles(const std::vector<double>& ps) const;
+};
+}
+
+template <typename... Metrics>
+struct BasicStats : Metrics... {
+    template <typename M>
+    static constexpr bool has = (std::is_same_v<M, Metrics> || ...);
+
+    void add_value(double value) { (Metrics::add(value), ...); }
+
+    double avg() const requires (has<metric::Sum> && has<metric::Count>) {
+        return this->count ? this->total / this->count : 0.0;
+    }
+    double median() const requires has<metric::Quantile> {
+        return this->quantiles({0.5})[0];
+    }
+    // 样本标准差：对保留的原始值两遍计算
+    double std_dev() const requires (has<metric::Quantile> && has<metric::Sum> && has<metric::Count>) {
+        if (this->values.size() < 2) return 0.0;
+        double variance = simd::sum_sq_dev(this->values.data(), this->values.size(), avg());
+        return std::sqrt(variance / (this->values.size() - 1));
+    }
+    bool operator<(const BasicStats& other) const requires has<metric::Sum> {
+        return this->total < other.total;
+    }
+};
+
+// 全量统计（总体金额，报告需要中位数/标准差）
+using Stats = BasicStats<metric::Sum, metric::Count, metric::MinMax, metric::Quantile>;
+// 各分组只声明报告实际用到的指标；商品不设全量分组（自由文本，键数无界），高频商品见 HeavyHitterStats
+using TypeStats = BasicStats<metric::Sum, metric::Count, metric::MinMax>;
+using CountryStats = BasicStats<metric::Sum, metric::Count>;
+using MonthlyStats = BasicStats<metric::Sum, metric::Count>;
+
+// 分组去重计数（HyperLogLog 近似），内存与去重元素个数无关
+struct DistinctStats {
+    static constexpr int GROUP_PRECISION = 10; // 每组 1KB，标准误差约 3.25%
+    HyperLogLog products{12};
+    HyperLogLog categories{12};
+    HyperLogLog countries{12};
+    std::map<std::string, HyperLogLog> products_per_month;
+    std::map<std::string, HyperLogLog> products_per_category;
+    std::map<std::string, HyperLogLog> categories_per_country;
+    void add(const Record& r, const std::string& month);
+    // 合并另一分区/线程的统计结果
+    void merge(const DistinctStats& other);
+    nlohmann::json to_json() const;
 };
 
-void compute_stats(const std::vector<Record>& records, std::map<std::string, Stats>& type_stats, std::map<std::string, Stats>& product_stats, std::map<std::string, Stats>& country_stats, std::map<std::string, Stats>& monthly_stats, std::map<std::string, Stats>& unit_price_stats, Stats& global_stats);
+// distinct_stats 非空时同时累计分组去重计数
+void compute_stats(const std::vector<Record>& records, std::map<std::string, TypeStats>& type_stats, std::map<std::string, CountryStats>& country_stats, std::map<std::string, MonthlyStats>& monthly_stats, Stats& global_stats, DistinctStats* distinct_stats = nullptr);
@@ -0,0 +1,30 @@
+#pragma once
+#include <map>
+#include <vector>
+
+// STL 季节-趋势分解（Cleveland et al. 1990），多季节版本按 MSTL（Bandara et al. 2021）逐个周期迭代。
+// 所有 LOESS 平滑都是局部线性、三次权重，只在每隔 jump 个点处求值再线性插值（原论文的 n_jump 加速），
+// 低通滤波用滑动和实现；窗口大小只取决于周期，因此每轮代价对序列长度是 O(n)。
+// 鲁棒版本用残差的双平方权重做外层迭代，单日尖峰不会被季节/趋势吸收。
+
+struct StlOptions {
+    int seasonal_window = 7;   // 季节子序列平滑窗口（奇数，>= 7）；0 为 periodic：子序列取鲁棒加权均值，季节形状固定
+    int inner_iterations = 2;
+    int outer_iterations = 2;  // 鲁棒迭代次数，0 为非鲁棒
+    int mstl_iterations = 2;   // 多季节时每个周期的来回轮数
+    std::map<int, int> period_windows; // MSTL 中按周期单独指定季节窗口（周期 -> 窗口），未列出的周期用 seasonal_window
+};
+
+struct StlDecomposition {
+    std::vector<int> periods;                    // 实际使用的周期（长度不足两个周期的被跳过）
+    std::vector<double> trend;
+    std::vector<std::vector<double>> seasonal;   // 与 periods 对应
+    std::vector<double> residual;
+};
+
+// 单周期 STL，seasonal/trend 输出长度与 y 相同；period < 2 或数据不足两个周期时季节项为 0
+void stl_decompose(const std::vector<double>& y, int period, const StlOptions& options,
+                   std::vector<double>& seasonal, std::vector<double>& trend);
+
+// 多季节分解：periods 按从小到大处理
+StlDecomposition mstl_decompose(const std::vector<double>& y, std::vector<int> periods, const StlOptions& options = {});
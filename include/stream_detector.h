@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "record.h"
+#include "json.hpp"
+
+// 流式异常检测：解析时逐条 observe，按类别、按商品各维护一份指数加权（EWMA）均值/方差，
+// 单条记录 O(1)。金额取 log1p 后建模，长尾金额不会淹没小额类别。
+// 评分用更新前的统计量：|z| 超过阈值且该组已见过 warmup 条记录时立即报警（回调 + 内部列表）。
+// 更新时把观测截断到 均值 ± 阈值·标准差，单个尖峰不会抬高方差而掩盖随后的异常。
+// 内存中只保留最近 max_alerts 条报警（回调仍收到全部），JSON 输出这些报警与报警总数。
+//
+// 状态持久化：state() 保存各组 EWMA、已处理条数与记录摘要（逐条链式 FNV-1a），下次运行先 resume()，
+// 在收到第一条记录时决定续接方式：
+// - 首条记录与上次相同（全量重跑）：从头重新累计，结果与保存的状态一致；前 observed 条的报警上次已发出，
+//   暂存而不送回调。到达第 observed 条时摘要一致即丢弃暂存，不一致（历史被改写）则补发；
+// - 否则视为新追加的记录，直接在保存的状态上继续更新。
+// 批量运行用最终状态（含续接来的历史）对全部记录评分，见 batch_json。
+
+struct StreamAlert {
+    size_t sequence = 0;      // 到达序号（从 0 开始，续接时接着上次的序号）
+    std::string group;        // "category" / "product"
+    std::string key;
+    std::string time;
+    std::string remark;
+    double amount = 0.0;
+    double expected = 0.0;    // 该组 EWMA 均值对应的金额
+    double z = 0.0;
+    nlohmann::json to_json() const;
+};
+
+class StreamingAnomalyDetector {
+public:
+    // half_life：权重衰减一半所需的组内观测数
+    explicit StreamingAnomalyDetector(double half_life = 30.0, double z_threshold = 3.5, size_t warmup = 20,
+                                      size_t max_alerts = 1000);
+    // 每条报警产生时调用（如写入实时报警文件）
+    void set_sink(std::function<void(const StreamAlert&)> sink) { on_alert = std::move(sink); }
+    // 载入上次保存的状态，须在第一次 observe 之前调用；参数不一致或格式不符时返回 false
+    bool resume(const nlohmann::json& saved);
+    // 处理一条记录，返回本条触发的报警数
+    size_t observe(const Record& record);
+    // 输入结束：全量重跑但输入短于上次时，补发暂存的报警
+    void finish();
+    // 按当前状态给单条记录评分（不更新）：类别、商品两组中已过 warmup 者的最大 |z|，都未过时为 0
+    double score(const Record& record) const;
+    // 批量评分：超过阈值的条数与 |z| 最高的 top 条
+    nlohmann::json batch_json(const std::vector<Record>& records, size_t top = 20) const;
+    const std::deque<StreamAlert>& alerts() const { return emitted; }
+    size_t observed() const { return n_seen; }
+    size_t alert_count() const { return n_alerts; }
+    nlohmann::json state() const;
+    nlohmann::json to_json() const;
+
+private:
+    struct Ewma {
+        double mean = 0.0, var = 0.0;
+        size_t n = 0;
+    };
+    using GroupMap = std::unordered_map<std::string, Ewma>;
+    // resume 载入、尚未决定续接方式的状态
+    struct Snapshot {
+        GroupMap by_category, by_product;
+        size_t observed = 0, alerts = 0;
+        uint64_t digest = 0, first_digest = 0;
+    };
+    double alpha, threshold;
+    size_t warmup, max_alerts;
+    size_t n_seen = 0, n_alerts = 0;
+    uint64_t digest, first_digest = 0;
+    GroupMap by_category, by_product;
+    std::deque<StreamAlert> emitted;
+    std::function<void(const StreamAlert&)> on_alert;
+    bool has_saved = false;
+    Snapshot saved;
+    // 全量重跑时：到 replay_until 条为止的报警暂存在 pending（至多 max_alerts 条）
+    size_t replay_until = 0;
+    uint64_t replay_digest = 0;
+    std::vector<StreamAlert> pending;
+    size_t pending_dropped = 0;
+    // 先评分后更新；超阈值时返回 true 并写入 z/expected
+    bool score_and_update(Ewma& s, double x, double& z, double& expected) const;
+    void emit(StreamAlert&& alert);
+    void end_replay(bool matched);
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 字符串驻留：把重复出现的键（类别、商品名等）映射为连续的 uint32_t 编号，
+// 之后的分组、排序、并行调度都只处理整数，名字只在输出时查回一次。
+// 编号按首次出现顺序分配，同一输入顺序总得到同一编号。
+
+class StringInterner {
+public:
+    uint32_t intern(const std::string& s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        const uint32_t id = static_cast<uint32_t>(names.size());
+        names.emplace_back(s);
+        ids.emplace(s, id);
+        return id;
+    }
+    const std::string& name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+private:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t> ids;
+};
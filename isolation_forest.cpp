@@ -0,0 +1,124 @@
+#include "include/isolation_forest.h"
+#include "include/counter_rng.h"
+#include "include/parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+// 二叉搜索树不成功查找的平均路径长度
+static double average_path(size_t n) {
+    if (n <= 1) return 0.0;
+    if (n == 2) return 1.0;
+    const double harmonic = std::log(n - 1.0) + 0.5772156649015329;
+    return 2.0 * harmonic - 2.0 * (n - 1.0) / n;
+}
+
+IsolationForest::IsolationForest(size_t n_trees, size_t sample_size, uint64_t seed)
+    : n_trees(std::max<size_t>(n_trees, 1)), sample_size(std::max<size_t>(sample_size, 2)), seed(seed) {}
+
+void IsolationForest::fit(const float* data, size_t n, size_t d, unsigned threads) {
+    nodes.clear();
+    roots.clear();
+    dim = d;
+    if (n == 0 || d == 0) return;
+    const size_t psi = std::min(sample_size, n);
+    const int max_depth = static_cast<int>(std::ceil(std::log2(static_cast<double>(std::max<size_t>(psi, 2)))));
+    norm = std::max(average_path(psi), 1e-9);
+
+    std::vector<std::vector<Node>> trees(n_trees);
+    parallel_for(n_trees, [&](size_t t) {
+        uint64_t counter = 0;
+        auto next_uniform = [&]() { return counter_uniform(seed, t, counter++); };
+        // 不放回子样本：Floyd 算法，只抽 psi 个下标，代价 O(psi) 而与 n 无关
+        std::vector<uint32_t> idx;
+        idx.reserve(psi);
+        std::unordered_set<uint32_t> chosen;
+        chosen.reserve(2 * psi);
+        for (size_t j = n - psi; j < n; ++j) {
+            uint32_t pick = static_cast<uint32_t>(counter_index(seed, t, counter++, j + 1));
+            if (!chosen.insert(pick).second) {
+                pick = static_cast<uint32_t>(j);
+                chosen.insert(pick);
+            }
+            idx.push_back(pick);
+        }
+
+        std::vector<Node>& tree = trees[t];
+        tree.reserve(2 * psi);
+        // 显式栈：(节点下标, 样本区间 [lo, hi), 深度)
+        struct Task { int32_t node; size_t lo, hi; int depth; };
+        std::vector<Task> stack = {{0, 0, psi, 0}};
+        tree.push_back({0.0f, -1, 0});
+        while (!stack.empty()) {
+            Task task = stack.back();
+            stack.pop_back();
+            const size_t size = task.hi - task.lo;
+            // 随机挑一个在当前样本上有取值范围的特征，最多尝试 dim 次
+            int feature = -1;
+            float lo_v = 0, hi_v = 0;
+            if (task.depth < max_depth && size > 1) {
+                for (size_t attempt = 0; attempt < dim && feature < 0; ++attempt) {
+                    const size_t f = counter_index(seed, t, counter++, dim);
+                    lo_v = hi_v = data[idx[task.lo] * dim + f];
+                    for (size_t i = task.lo + 1; i < task.hi; ++i) {
+                        const float v = data[idx[i] * dim + f];
+                        lo_v = std::min(lo_v, v);
+                        hi_v = std::max(hi_v, v);
+                    }
+                    if (hi_v > lo_v) feature = static_cast<int>(f);
+                }
+            }
+            if (feature < 0) {
+                tree[task.node] = {static_cast<float>(average_path(size)), -1, 0};
+                continue;
+            }
+            float split = lo_v + static_cast<float>(next_uniform()) * (hi_v - lo_v);
+            if (split <= lo_v) split = std::nextafter(lo_v, hi_v);
+            auto mid = std::partition(idx.begin() + task.lo, idx.begin() + task.hi,
+                                      [&](uint32_t i) { return data[i * dim + feature] < split; });
+            const size_t cut = mid - idx.begin();
+            const int32_t left = static_cast<int32_t>(tree.size());
+            tree[task.node] = {split, feature, left};
+            tree.push_back({0.0f, -1, 0});
+            tree.push_back({0.0f, -1, 0});
+            stack.push_back({left, task.lo, cut, task.depth + 1});
+            stack.push_back({left + 1, cut, task.hi, task.depth + 1});
+        }
+    }, threads);
+
+    // 按树序拼接为扁平数组，子节点下标平移为全局下标
+    size_t total = 0;
+    for (const auto& tree : trees) total += tree.size();
+    nodes.reserve(total);
+    for (const auto& tree : trees) {
+        const int32_t base = static_cast<int32_t>(nodes.size());
+        roots.push_back(base);
+        for (Node node : tree) {
+            if (node.feature >= 0) node.left += base;
+            nodes.push_back(node);
+        }
+    }
+}
+
+std::vector<double> IsolationForest::score(const float* data, size_t n, unsigned threads) const {
+    std::vector<double> scores(n, 0.0);
+    if (!is_fitted()) return scores;
+    const size_t chunk = 256, n_chunks = (n + chunk - 1) / chunk;
+    parallel_for(n_chunks, [&](size_t c) {
+        for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+            const float* x = data + i * dim;
+            double path_sum = 0.0;
+            for (int32_t root : roots) {
+                int32_t k = root;
+                int depth = 0;
+                while (nodes[k].feature >= 0) {
+                    k = nodes[k].left + (x[nodes[k].feature] < nodes[k].value ? 0 : 1);
+                    depth++;
+                }
+                path_sum += depth + nodes[k].value;
+            }
+            scores[i] = std::pow(2.0, -(path_sum / roots.size()) / norm);
+        }
+    }, threads);
+    return scores;
+}
@@ -0,0 +1,108 @@
+#include "include/kalman.h"
+#include <algorithm>
+#include <cmath>
+
+static const double LOG_2PI = std::log(2.0 * M_PI);
+
+double KalmanWorkspace::Result::neg2_loglik() const {
+    if (n == 0) return 0.0;
+    const double s2 = std::max(sigma2(), 1e-300);
+    return n * (LOG_2PI + std::log(s2) + 1.0) + sum_log_f;
+}
+
+void KalmanWorkspace::resize(int ar_order, int ma_order) {
+    p = ar_order;
+    q = ma_order;
+    const int dim = std::max(p, q + 1);
+    if (dim == r) return;
+    r = dim;
+    a.assign(r, 0.0);
+    a_tmp.assign(r, 0.0);
+    P.assign(r * r, 0.0);
+    TP.assign(r * r, 0.0);
+    A.assign(r * r, 0.0);
+    AP.assign(r * r, 0.0);
+    RR.assign(r * r, 0.0);
+    tcol.assign(r, 0.0);
+    rvec.assign(r, 0.0);
+}
+
+// 倍增法：P = sum_k T^k RR' T'^k，每轮 P += A P A'、A = A A，A 收敛到 0 即止
+void KalmanWorkspace::stationary_covariance() {
+    P = RR;
+    std::fill(A.begin(), A.end(), 0.0);
+    for (int i = 0; i < r; ++i) {
+        A[i * r] = tcol[i];
+        if (i + 1 < r) A[i * r + i + 1] = 1.0;
+    }
+    for (int iter = 0; iter < 60; ++iter) {
+        // AP = A * P；TP 暂存 A P A'
+        for (int i = 0; i < r; ++i)
+            for (int j = 0; j < r; ++j) {
+                double s = 0.0;
+                for (int k = 0; k < r; ++k) s += A[i * r + k] * P[k * r + j];
+                AP[i * r + j] = s;
+            }
+        double growth = 0.0;
+        for (int i = 0; i < r; ++i)
+            for (int j = 0; j < r; ++j) {
+                double s = 0.0;
+                for (int k = 0; k < r; ++k) s += AP[i * r + k] * A[j * r + k];
+                TP[i * r + j] = s;
+                growth = std::max(growth, std::abs(s));
+            }
+        for (int i = 0; i < r * r; ++i) P[i] += TP[i];
+        if (growth < 1e-12 || !std::isfinite(growth)) break;
+        // A = A * A（AP 作临时）
+        for (int i = 0; i < r; ++i)
+            for (int j = 0; j < r; ++j) {
+                double s = 0.0;
+                for (int k = 0; k < r; ++k) s += A[i * r + k] * A[k * r + j];
+                AP[i * r + j] = s;
+            }
+        A.swap(AP);
+    }
+}
+
+KalmanWorkspace::Result KalmanWorkspace::filter(const double* w, size_t n, const double* phi, const double* theta,
+                                                double* innovations) {
+    Result res;
+    for (int i = 0; i < r; ++i) {
+        tcol[i] = i < p ? phi[i] : 0.0;
+        rvec[i] = i == 0 ? 1.0 : (i - 1 < q ? theta[i - 1] : 0.0);
+    }
+    for (int i = 0; i < r; ++i)
+        for (int j = 0; j < r; ++j) RR[i * r + j] = rvec[i] * rvec[j];
+    stationary_covariance();
+    std::fill(a.begin(), a.end(), 0.0);
+
+    for (size_t t = 0; t < n; ++t) {
+        // 更新：观测为状态第一分量，F = P[0][0]
+        const double v = w[t] - a[0];
+        const double F = P[0];
+        if (innovations) innovations[t] = v;
+        if (!(F > 1e-12) || !std::isfinite(F)) {
+            res.sum_sq = res.sum_log_f = INFINITY;
+            return res;
+        }
+        res.sum_sq += v * v / F;
+        res.sum_log_f += std::log(F);
+        res.n++;
+        // a += K v，P -= P[:,0] P[0,:] / F
+        for (int i = 0; i < r; ++i) a[i] += P[i * r] / F * v;
+        for (int i = 0; i < r; ++i) {
+            const double ki = P[i * r] / F;
+            for (int j = 0; j < r; ++j) AP[i * r + j] = P[i * r + j] - ki * P[j];
+        }
+        // 预测：a = T a，P = T P T' + RR'，利用 T 的结构逐项展开
+        for (int i = 0; i < r; ++i) a_tmp[i] = tcol[i] * a[0] + (i + 1 < r ? a[i + 1] : 0.0);
+        a.swap(a_tmp);
+        for (int i = 0; i < r; ++i)
+            for (int j = 0; j < r; ++j)
+                TP[i * r + j] = tcol[i] * AP[j] + (i + 1 < r ? AP[(i + 1) * r + j] : 0.0);
+        for (int i = 0; i < r; ++i)
+            for (int j = 0; j < r; ++j)
+                P[i * r + j] = TP[i * r] * tcol[j] + (j + 1 < r ? TP[i * r + j + 1] : 0.0) + RR[i * r + j];
+    }
+    return res;
+}
@@ -0,0 +1,145 @@
+#include "include/kd_tree.h"
+#include "include/parallel.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+void KdTree::build(const float* d, size_t count, size_t dimension) {
+    data = d;
+    n = count;
+    dim = dimension;
+    nodes.clear();
+    perm.resize(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    if (n == 0 || dim == 0) return;
+    nodes.reserve(4 * (n / std::max<size_t>(leaf_size, 1) + 1));
+    boxes.reserve(nodes.capacity() * 2 * dim);
+    nodes.push_back({});
+    boxes.assign(2 * dim, 0.0f);
+    build_node(0, 0, static_cast<uint32_t>(n));
+    points.resize(n * dim);
+    for (size_t p = 0; p < n; ++p) std::copy_n(data + static_cast<size_t>(perm[p]) * dim, dim, points.data() + p * dim);
+}
+
+void KdTree::build_node(uint32_t node, uint32_t begin, uint32_t end) {
+    // 包围盒，同时找跨度最大的维度
+    float* lo = boxes.data() + static_cast<size_t>(node) * 2 * dim;
+    float* hi = lo + dim;
+    int best_dim = -1;
+    float best_spread = 0.0f;
+    for (size_t c = 0; c < dim; ++c) {
+        lo[c] = hi[c] = data[perm[begin] * dim + c];
+        for (uint32_t i = begin + 1; i < end; ++i) {
+            const float v = data[perm[i] * dim + c];
+            lo[c] = std::min(lo[c], v);
+            hi[c] = std::max(hi[c], v);
+        }
+        if (hi[c] - lo[c] > best_spread) { best_spread = hi[c] - lo[c]; best_dim = static_cast<int>(c); }
+    }
+    nodes[node] = {0.0f, -1, 0, begin, end};
+    if (end - begin <= leaf_size) return;
+    if (best_dim < 0) {
+        // 全部重合：按行号排序，查询时按 (距离, 下标) 顺序扫描，可提前结束
+        std::sort(perm.begin() + begin, perm.begin() + end);
+        nodes[node].split_dim = COINCIDENT;
+        return;
+    }
+    const uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(perm.begin() + begin, perm.begin() + mid, perm.begin() + end, [&](uint32_t a, uint32_t b) {
+        const float va = data[a * dim + best_dim], vb = data[b * dim + best_dim];
+        return va != vb ? va < vb : a < b;
+    });
+    const uint32_t left = static_cast<uint32_t>(nodes.size());
+    nodes[node] = {data[perm[mid] * dim + best_dim], best_dim, left, begin, end};
+    nodes.push_back({});
+    nodes.push_back({});
+    boxes.resize(nodes.size() * 2 * dim);
+    build_node(left, begin, mid);
+    build_node(left + 1, mid, end);
+}
+
+inline float KdTree::box_distance(uint32_t node, const float* q) const {
+    const float* lo = boxes.data() + static_cast<size_t>(node) * 2 * dim;
+    const float* hi = lo + dim;
+    float s = 0.0f;
+    for (size_t c = 0; c < dim; ++c) {
+        const float d = std::max(lo[c] - q[c], 0.0f) + std::max(q[c] - hi[c], 0.0f);
+        s += d * d;
+    }
+    return s;
+}
+
+size_t KdTree::query_point(size_t i, size_t k, uint32_t* idx, float* dist2) const {
+    if (n == 0 || k == 0) return 0;
+    const float* q = data + i * dim;
+    // 最大堆：堆顶为当前第 k 近（距离相同时下标大者在顶）
+    // 线程局部缓冲，批量查询时不反复分配
+    thread_local std::vector<std::pair<float, uint32_t>> heap;
+    thread_local std::vector<std::pair<uint32_t, float>> stack;
+    heap.clear();
+    // 显式栈：(节点, 到该节点区域的距离下界)
+    stack.assign(1, {0, 0.0f});
+    auto worst = [&]() { return heap.size() < k ? std::numeric_limits<float>::infinity() : heap.front().first; };
+    while (!stack.empty()) {
+        auto [node_id, bound] = stack.back();
+        stack.pop_back();
+        if (bound > worst()) continue;
+        const Node& node = nodes[node_id];
+        if (node.split_dim < 0) {
+            const bool coincident = node.split_dim == COINCIDENT;
+            auto distance = [&](uint32_t p) {
+                const float* x = points.data() + static_cast<size_t>(p) * dim;
+                float s = 0.0f;
+                for (size_t c = 0; c < dim; ++c) s += (x[c] - q[c]) * (x[c] - q[c]);
+                return s;
+            };
+            const float same = coincident ? distance(node.begin) : 0.0f;
+            for (uint32_t p = node.begin; p < node.end; ++p) {
+                const uint32_t j = perm[p];
+                if (j == i) continue;
+                const std::pair<float, uint32_t> cand(coincident ? same : distance(p), j);
+                if (heap.size() < k) {
+                    heap.push_back(cand);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (cand < heap.front()) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = cand;
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (coincident) {
+                    break; // 其余点距离相同、下标更大，不会更近
+                }
+            }
+            continue;
+        }
+        // 较近的子节点后入栈、先访问
+        const float d_left = box_distance(node.left, q), d_right = box_distance(node.left + 1, q);
+        if (d_left <= d_right) {
+            stack.push_back({node.left + 1, d_right});
+            stack.push_back({node.left, d_left});
+        } else {
+            stack.push_back({node.left, d_left});
+            stack.push_back({node.left + 1, d_right});
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end());
+    for (size_t j = 0; j < heap.size(); ++j) {
+        idx[j] = heap[j].second;
+        dist2[j] = heap[j].first;
+    }
+    return heap.size();
+}
+
+void KdTree::all_knn(size_t k, std::vector<uint32_t>& idx, std::vector<float>& dist2, unsigned threads) const {
+    idx.assign(n * k, std::numeric_limits<uint32_t>::max());
+    dist2.assign(n * k, std::numeric_limits<float>::infinity());
+    // 按树内顺序分块领取：块内查询点空间相邻，也减少原子计数器争用
+    const size_t block = 256;
+    parallel_for((n + block - 1) / block, [&](size_t b) {
+        const size_t end = std::min(n, (b + 1) * block);
+        for (size_t p = b * block; p < end; ++p) {
+            const size_t i = perm[p];
+            query_point(i, k, idx.data() + i * k, dist2.data() + i * k);
+        }
+    }, threads);
+}
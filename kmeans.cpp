@@ -0,0 +1,180 @@
+#include "include/cluster_analyzer.h"
+#include "include/kmeans_kernels.h"
+#include "include/counter_rng.h"
+#include "include/parallel.h"
+#include "include/simd_kernels.h"
+#include <algorithm>
+#include <limits>
+
+namespace kmeans {
+
+Columns::Columns(const FeatureMatrix& fm) : Columns(fm.data(), fm.rows, fm.dim) {}
+
+Columns::Columns(const float* rows, size_t count, size_t d) { assign(rows, count, d); }
+
+void Columns::assign(const float* rows, size_t count, size_t d) {
+    n = count;
+    dim = d;
+    data.resize(count * d);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < dim; ++j) data[j * n + i] = rows[i * dim + j];
+    }
+}
+
+// 块 [begin, end) 内各点到质心的平方距离写入 dist
+static void block_distance(const Columns& x, size_t begin, size_t end, const float* center, float* dist) {
+    std::fill(dist, dist + (end - begin), 0.0f);
+    for (size_t d = 0; d < x.dim; ++d) simd::squared_distance_accumulate(x.col(d) + begin, end - begin, center[d], dist);
+}
+
+void block_assign(const Columns& x, size_t begin, size_t end, const std::vector<float>& centers, int k,
+                  float* best, uint32_t* label, std::vector<float>& dist) {
+    const size_t len = end - begin;
+    dist.resize(len);
+    std::fill(best, best + len, std::numeric_limits<float>::infinity());
+    for (int c = 0; c < k; ++c) {
+        block_distance(x, begin, end, centers.data() + c * x.dim, dist.data());
+        for (size_t i = 0; i < len; ++i) {
+            if (dist[i] < best[i]) { best[i] = dist[i]; label[i] = c; }
+        }
+    }
+}
+
+std::vector<uint32_t> assign_all(const Columns& x, const std::vector<float>& centers, int k, unsigned threads) {
+    std::vector<uint32_t> label(x.n);
+    parallel_for((x.n + BLOCK - 1) / BLOCK, [&](size_t b) {
+        const size_t begin = b * BLOCK, end = std::min(x.n, begin + BLOCK);
+        std::vector<float> best(end - begin), dist;
+        block_assign(x, begin, end, centers, k, best.data(), label.data() + begin, dist);
+    }, threads);
+    return label;
+}
+
+std::vector<uint32_t> assign_rows(const FeatureMatrix& fm, const std::vector<float>& centers, int k, unsigned threads) {
+    const size_t n = fm.rows;
+    std::vector<uint32_t> label(n);
+    parallel_for((n + BLOCK - 1) / BLOCK, [&](size_t b) {
+        const size_t begin = b * BLOCK, len = std::min(n, begin + BLOCK) - begin;
+        thread_local Columns tile;
+        thread_local std::vector<float> best, dist;
+        tile.assign(fm.row(begin), len, fm.dim);
+        best.resize(len);
+        block_assign(tile, 0, len, centers, k, best.data(), label.data() + begin, dist);
+    }, threads);
+    return label;
+}
+
+std::vector<float> plus_plus(const Columns& x, int k, uint64_t seed, unsigned threads) {
+    const size_t n = x.n, dim = x.dim, blocks = (n + BLOCK - 1) / BLOCK;
+    std::vector<float> centers(k * dim);
+    auto take = [&](int c, size_t row) {
+        for (size_t d = 0; d < dim; ++d) centers[c * dim + d] = x.col(d)[row];
+    };
+    take(0, counter_index(seed, 0, 0, n));
+    std::vector<float> min_dist(n, std::numeric_limits<float>::infinity());
+    std::vector<double> block_sum(blocks);
+    for (int c = 1; c < k; ++c) {
+        // 用第 c-1 个质心更新最小距离；块和按块序累加，抽样结果与线程数无关
+        parallel_for(blocks, [&](size_t b) {
+            const size_t begin = b * BLOCK, end = std::min(n, begin + BLOCK);
+            std::vector<float> dist(end - begin);
+            block_distance(x, begin, end, centers.data() + (c - 1) * dim, dist.data());
+            double s = 0.0;
+            for (size_t i = begin; i < end; ++i) s += min_dist[i] = std::min(min_dist[i], dist[i - begin]);
+            block_sum[b] = s;
+        }, threads);
+        double total = 0.0;
+        for (double s : block_sum) total += s;
+        if (total <= 0.0) { take(c, counter_index(seed, 0, c, n)); continue; } // 所有点与已选质心重合
+        double target = counter_uniform(seed, 0, c) * total;
+        size_t b = 0;
+        while (b + 1 < blocks && target >= block_sum[b]) target -= block_sum[b++];
+        size_t row = std::min(n, (b + 1) * BLOCK) - 1;
+        for (size_t i = b * BLOCK; i < std::min(n, (b + 1) * BLOCK); ++i) {
+            if (target < min_dist[i]) { row = i; break; }
+            target -= min_dist[i];
+        }
+        take(c, row);
+    }
+    return centers;
+}
+
+std::vector<ClusterInfo> make_clusters(const std::vector<uint32_t>& label, const std::vector<float>& centers, int k,
+                                       size_t dim, const std::vector<Record>& records) {
+    std::vector<ClusterInfo> clusters(k);
+    for (size_t i = 0; i < label.size(); ++i) {
+        clusters[label[i]].member_indices.push_back(i);
+        clusters[label[i]].cluster_total += records[i].amount;
+    }
+    for (int c = 0; c < k; ++c) {
+        ClusterInfo& info = clusters[c];
+        info.avg_amount = info.member_indices.empty() ? 0.0 : info.cluster_total / info.member_indices.size();
+        info.centroid.assign(centers.begin() + c * dim, centers.begin() + (c + 1) * dim);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const ClusterInfo& a, const ClusterInfo& b) {
+        return a.avg_amount > b.avg_amount;
+    });
+    for (int c = 0; c < k; ++c) clusters[c].label = "Cluster " + std::to_string(c + 1);
+    return clusters;
+}
+
+} // namespace kmeans
+
+std::vector<ClusterInfo> ClusterAnalyzer::kmeans_cluster(const FeatureMatrix& features, const std::vector<Record>& records,
+                                                         int num_clusters, uint64_t seed, int max_iterations, unsigned threads) {
+    const size_t n = features.rows, dim = features.dim;
+    if (n == 0 || n != records.size() || num_clusters <= 0) return {};
+    if (n >= MINI_BATCH_ROWS) return minibatch_kmeans_cluster(features, records, num_clusters, seed, 4096, 500, threads);
+    const int k = static_cast<int>(std::min<size_t>(num_clusters, n));
+    const kmeans::Columns x(features);
+    std::vector<float> centers = kmeans::plus_plus(x, k, seed, threads);
+
+    // Lloyd 迭代：每块独立的质心和/计数，按块序归并
+    const size_t blocks = (n + kmeans::BLOCK - 1) / kmeans::BLOCK;
+    std::vector<uint32_t> label(n, UINT32_MAX);
+    std::vector<float> best(n);
+    std::vector<double> block_sums(blocks * k * dim);
+    std::vector<size_t> block_counts(blocks * k), block_changed(blocks);
+    for (int it = 0; it < std::max(1, max_iterations); ++it) {
+        parallel_for(blocks, [&](size_t b) {
+            const size_t begin = b * kmeans::BLOCK, end = std::min(n, begin + kmeans::BLOCK);
+            std::vector<uint32_t> fresh(end - begin);
+            std::vector<float> dist;
+            kmeans::block_assign(x, begin, end, centers, k, best.data() + begin, fresh.data(), dist);
+            double* sums = block_sums.data() + b * k * dim;
+            size_t* counts = block_counts.data() + b * k;
+            std::fill(sums, sums + k * dim, 0.0);
+            std::fill(counts, counts + k, 0);
+            size_t changed = 0;
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t c = fresh[i - begin];
+                changed += label[i] != c;
+                label[i] = c;
+                counts[c]++;
+                for (size_t d = 0; d < dim; ++d) sums[c * dim + d] += x.col(d)[i];
+            }
+            block_changed[b] = changed;
+        }, threads);
+        std::vector<double> sums(k * dim, 0.0);
+        std::vector<size_t> counts(k, 0);
+        size_t changed = 0;
+        for (size_t b = 0; b < blocks; ++b) {
+            for (size_t j = 0; j < sums.size(); ++j) sums[j] += block_sums[b * k * dim + j];
+            for (int c = 0; c < k; ++c) counts[c] += block_counts[b * k + c];
+            changed += block_changed[b];
+        }
+        if (changed == 0) break;
+        for (int c = 0; c < k; ++c) {
+            if (counts[c] == 0) {
+                // 空簇：移到离其质心最远的点（同距离取下标小者），并让该点不再被重复选中
+                const size_t far = std::max_element(best.begin(), best.end()) - best.begin();
+                for (size_t d = 0; d < dim; ++d) centers[c * dim + d] = x.col(d)[far];
+                best[far] = 0.0f;
+                continue;
+            }
+            for (size_t d = 0; d < dim; ++d) centers[c * dim + d] = static_cast<float>(sums[c * dim + d] / counts[c]);
+        }
+    }
+
+    return kmeans::make_clusters(label, centers, k, dim, records);
+}
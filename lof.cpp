@@ -0,0 +1,51 @@
+#include "include/anomaly_detector.h"
+#include "include/kd_tree.h"
+#include "include/parallel.h"
+#include <algorithm>
+#include <cmath>
+
+// 可达距离下限：输入为标准化特征时，0.01 个标准差以内视为重合，
+// 避免大量重复记录（同一商品同价重复购买）使局部密度趋于无穷
+static constexpr double MIN_REACH_DISTANCE = 1e-2;
+
+std::vector<double> local_outlier_factor(const float* data, size_t n, size_t dim, size_t k, unsigned threads) {
+    std::vector<double> lof(n, 1.0);
+    k = std::min(k, n ? n - 1 : 0);
+    if (k == 0 || dim == 0) return lof;
+
+    // 1. 一次性并行 kNN，后续各轮只读邻居表
+    KdTree tree;
+    tree.build(data, n, dim);
+    std::vector<uint32_t> idx;
+    std::vector<float> dist2;
+    tree.all_knn(k, idx, dist2, threads);
+
+    // 2. k-距离
+    std::vector<double> k_distance(n);
+    for (size_t i = 0; i < n; ++i) k_distance[i] = std::sqrt(static_cast<double>(dist2[i * k + k - 1]));
+
+    // 3. 局部可达密度 lrd(p) = 1 / mean_o max(k-dist(o), d(p, o))
+    const size_t block = 1024;
+    const size_t blocks = (n + block - 1) / block;
+    std::vector<double> lrd(n);
+    parallel_for(blocks, [&](size_t b) {
+        for (size_t i = b * block; i < std::min(n, (b + 1) * block); ++i) {
+            double reach = 0.0;
+            for (size_t j = 0; j < k; ++j) {
+                const uint32_t o = idx[i * k + j];
+                reach += std::max(k_distance[o], std::sqrt(static_cast<double>(dist2[i * k + j])));
+            }
+            lrd[i] = 1.0 / std::max(reach / k, MIN_REACH_DISTANCE);
+        }
+    }, threads);
+
+    // 4. LOF(p) = mean_o lrd(o) / lrd(p)
+    parallel_for(blocks, [&](size_t b) {
+        for (size_t i = b * block; i < std::min(n, (b + 1) * block); ++i) {
+            double sum = 0.0;
+            for (size_t j = 0; j < k; ++j) sum += lrd[idx[i * k + j]];
+            lof[i] = sum / k / lrd[i];
+        }
+    }, threads);
+    return lof;
+}
@@ -4,6 +4,11 @@
 #include "include/complex_analyzer.h"
 #include "include/analysis_result.h"
 #include "include/i18n.h"
+#include "include/sampler.h"
+#include "include/forecast_analyzer.h"
+#include "include/backtest.h"
+#include "include/stream_detector.h"
+#include "include/heavy_hitters.h"
 #include <iostream>
 #include <filesystem>
 #include <json.hpp>
@@ -15,6 +20,11 @@ int main(int argc, char* argv[]) {
     std::string filename;
     std::string lang = "zh_CN";
     std::string out_json = "analysis.json";
+    size_t sample_per_stratum = 0; // >0 时启用分层抽样近似分析
+    std::string state_file;        // 非空时持久化预测模型状态，后续运行增量更新（输入为全量历史）
+    std::string stream_state_file; // 非空时持久化流式检测状态，输入可只含新追加的记录
+    bool backtest = false;         // 滚动起点回测各候选预测模型
+    std::string alerts_file;       // 非空时解析期的流式异常报警逐行写入该文件（JSON Lines）
     // 完整命令行参数解析，支持任意顺序和国际化
     std::string next_opt;
     for (int i = 1; i < argc; ++i) {
@@ -22,6 +32,16 @@ int main(int argc, char* argv[]) {
         if (!next_opt.empty()) {
             if (next_opt == "lang") lang = arg;
             else if (next_opt == "output") out_json = arg;
+            else if (next_opt == "sample") {
+                try { sample_per_stratum = std::stoul(arg); } catch (...) { sample_per_stratum = 0; }
+                if (sample_per_stratum < 2) {
+                    std::cerr << "Warning: --sample needs at least 2 records per stratum, got '" << arg << "'; sampling disabled" << std::endl;
+                    sample_per_stratum = 0;
+                }
+            }
+            else if (next_opt == "state") state_file = arg;
+            else if (next_opt == "stream-state") stream_state_file = arg;
+            else if (next_opt == "alerts") alerts_file = arg;
             next_opt.clear();
             continue;
         }
@@ -29,6 +49,16 @@ int main(int argc, char* argv[]) {
             next_opt = "lang";
         } else if (arg == "-o" || arg == "--output") {
             next_opt = "output";
+        } else if (arg == "--sample") {
+            next_opt = "sample";
+        } else if (arg == "--state") {
+            next_opt = "state";
+        } else if (arg == "--stream-state") {
+            next_opt = "stream-state";
+        } else if (arg == "--alerts") {
+            next_opt = "alerts";
+        } else if (arg == "--backtest") {
+            backtest = true;
         } else if (!arg.empty() && arg[0] != '-' && filename.empty()) {
             filename = arg;
         }
@@ -50,25 +80,87 @@ int main(int argc, char* argv[]) {
         std::cerr << (lang == "en_US" ? "Failed to load language pack: " : "语言包加载失败: ") << lang << std::endl;
         return 1;
     }
-    auto records = parse_csv(filename);
+    // 流式异常检测：每条记录解析出来即更新并评分，--alerts 时报警实时落盘
+    StreamingAnomalyDetector stream_detector;
+    std::ofstream alerts_out;
+    if (!alerts_file.empty()) {
+        alerts_out.open(alerts_file);
+        if (!alerts_out) {
+            std::cerr << "Warning: cannot write alerts " << alerts_file << std::endl;
+        } else {
+            stream_detector.set_sink([&](const StreamAlert& a) { alerts_out << a.to_json().dump() << std::endl; });
+        }
+    }
+    // 流式检测状态单独存放：它按到达顺序续接（输入可只含新记录），与要求全量历史的 --state 规则不同
+    if (!stream_state_file.empty()) {
+        std::ifstream in(stream_state_file);
+        if (in.is_open() && !stream_detector.resume(nlohmann::json::parse(in, nullptr, false))) {
+            std::cerr << "Warning: ignoring incompatible stream state in " << stream_state_file << std::endl;
+        }
+    }
+    // 抽样模式：解析时即做分层水塘抽样，后续分析只在样本上进行
+    StratifiedSampler sampler(sample_per_stratum);
+    // 高频商品/备注/原产国：有界内存的 Space-Saving 摘要，解析时在全部记录上累计（抽样模式下也不受抽样影响）
+    HeavyHitterStats heavy_hitters;
+    std::vector<Record> records;
+    parse_csv_stream(filename, [&](Record&& r) {
+        stream_detector.observe(r);
+        heavy_hitters.add(r);
+        if (sample_per_stratum > 0) sampler.offer(std::move(r));
+        else records.push_back(std::move(r));
+    });
+    std::vector<double> sample_weights; // 抽样模式下每条样本的放大系数，报告据此加权
+    stream_detector.finish();
+    if (sample_per_stratum > 0) records = sampler.sample(&sample_weights);
     if (records.empty()) {
         std::cout << i18n.t("未找到有效记录") << std::endl;
         return 2;
     }
+    if (!stream_state_file.empty()) {
+        std::ofstream out(stream_state_file);
+        if (out.is_open()) out << stream_detector.state().dump();
+        else std::cerr << "Warning: cannot write stream state " << stream_state_file << std::endl;
+    }
+    // 抽样模式：日/月序列按放大系数加权；预测模型状态不持久化，避免估计序列上的模型与全量运行混用
+    const std::vector<double>* weights = sample_weights.empty() ? nullptr : &sample_weights;
+    if (weights && !state_file.empty()) {
+        std::cerr << "Warning: --state is ignored with --sample" << std::endl;
+        state_file.clear();
+    }
     // 复杂分析
-    AnalysisResult result = complex_analysis(records, i18n);
+    AnalysisResult result = complex_analysis(records, i18n, state_file, weights);
+    // 统计信息（同时累计分组去重计数，写入 analysis.json）
+    Stats global_stats;
+    std::map<std::string, TypeStats> type_stats;
+    std::map<std::string, CountryStats> country_stats;
+    std::map<std::string, MonthlyStats> monthly_stats;
+    DistinctStats distinct_stats;
+    compute_stats(records, type_stats, country_stats, monthly_stats, global_stats, &distinct_stats);
+    result.extra_json["distinct_counts"] = distinct_stats.to_json();
+    result.extra_json["heavy_hitters"] = heavy_hitters.to_json();
+    result.extra_json["stream_anomalies"] = stream_detector.to_json();
+    // 批量评分：用最终（含续接历史的）各组 EWMA 状态给本次全部记录打分
+    result.extra_json["stream_anomalies"]["batch"] = stream_detector.batch_json(records);
+    // 各类别/商品/国家的月度序列批量预测
+    GroupedSeries series = build_grouped_series(records, type_stats, country_stats, heavy_hitters.product_spend, weights);
+    batch_forecast_analysis(series, result);
+    if (backtest) {
+        BacktestOptions options;
+        auto scores = run_backtest(series.matrix, series.first_month, default_candidates(), options);
+        result.extra_json["backtest"] = backtest_to_json(scores, options);
+        result.extra_json["backtest"]["series_count"] = series.matrix.rows();
+    }
+    if (sample_per_stratum > 0) {
+        sampler.apply(result, type_stats, country_stats, monthly_stats, global_stats, &series);
+    }
     // 输出JSON
     std::ofstream jout(out_json);
     jout << result.to_json().dump(2);
     jout.close();
     std::cout << i18n.t("分析已完成，结果已输出到 ") << out_json << std::endl;
 
-    // 统计信息
-    Stats global_stats;
-    std::map<std::string, Stats> type_stats, product_stats, country_stats, monthly_stats, unit_price_stats;
-    compute_stats(records, type_stats, product_stats, country_stats, monthly_stats, unit_price_stats, global_stats);
     // 输出国际化文本报告
-    generate_report_i18n(records, global_stats, type_stats, product_stats, country_stats, monthly_stats, unit_price_stats, i18n, "report.txt");
+    generate_report_i18n(records, global_stats, type_stats, country_stats, monthly_stats, i18n, "report.txt", weights);
 
     return 0;
 }
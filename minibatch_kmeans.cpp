@@ -0,0 +1,65 @@
+#include "include/cluster_analyzer.h"
+#include "include/kmeans_kernels.h"
+#include "include/counter_rng.h"
+#include <algorithm>
+#include <limits>
+
+MiniBatchKMeans::MiniBatchKMeans(int k, size_t dim, uint64_t seed) : k(std::max(k, 1)), dim(dim), seed(seed) {}
+
+double MiniBatchKMeans::partial_fit(const float* rows, size_t n) {
+    if (!initialized()) {
+        // 播种：攒够 k 行后在已缓存的行上做 k-means++
+        pending.insert(pending.end(), rows, rows + n * dim);
+        const size_t have = pending.size() / dim;
+        if (have < static_cast<size_t>(k)) return -1.0;
+        center = kmeans::plus_plus(kmeans::Columns(pending.data(), have, dim), k, seed, 1);
+        count.assign(k, 0);
+        rows = pending.data();
+        n = have;
+    }
+    std::vector<float> before = center;
+    // 先用本批开始时的质心分配，再逐点更新（顺序固定，结果确定）
+    const kmeans::Columns x(rows, n, dim);
+    std::vector<uint32_t> label(n);
+    std::vector<float> best(n), dist;
+    for (size_t begin = 0; begin < n; begin += kmeans::BLOCK) {
+        const size_t end = std::min(n, begin + kmeans::BLOCK);
+        kmeans::block_assign(x, begin, end, center, k, best.data() + begin, label.data() + begin, dist);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t c = label[i];
+        const float eta = 1.0f / static_cast<float>(++count[c]);
+        float* ctr = center.data() + c * dim;
+        for (size_t d = 0; d < dim; ++d) ctr[d] += eta * (rows[i * dim + d] - ctr[d]);
+    }
+    pending.clear();
+    pending.shrink_to_fit();
+    double shift = 0.0;
+    for (size_t j = 0; j < center.size(); ++j) shift += (center[j] - before[j]) * (center[j] - before[j]);
+    return shift / k;
+}
+
+std::vector<ClusterInfo> ClusterAnalyzer::minibatch_kmeans_cluster(const FeatureMatrix& features, const std::vector<Record>& records,
+                                                                   int num_clusters, uint64_t seed, size_t batch_size,
+                                                                   size_t max_batches, unsigned threads) {
+    const size_t n = features.rows, dim = features.dim;
+    if (n == 0 || n != records.size() || num_clusters <= 0) return {};
+    const int k = static_cast<int>(std::min<size_t>(num_clusters, n));
+    batch_size = std::max<size_t>(batch_size, k);
+    MiniBatchKMeans model(k, dim, seed);
+    std::vector<float> batch(batch_size * dim);
+    // 收敛判据：质心平移量的指数平均（前 10 批不判）
+    double smoothed = -1.0;
+    for (size_t b = 0; b < max_batches; ++b) {
+        for (size_t j = 0; j < batch_size; ++j) {
+            const size_t row = counter_index(seed, b + 1, j, n);
+            std::copy_n(features.row(row), dim, batch.data() + j * dim);
+        }
+        const double shift = model.partial_fit(batch.data(), batch_size);
+        smoothed = smoothed < 0 ? shift : 0.7 * smoothed + 0.3 * shift;
+        if (b >= 10 && smoothed < 1e-6) break;
+    }
+    // 最终一次全量并行分配：逐块转置，额外内存只有每行一个标签
+    std::vector<uint32_t> label = kmeans::assign_rows(features, model.centers(), k, threads);
+    return kmeans::make_clusters(label, model.centers(), k, dim, records);
+}
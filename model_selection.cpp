@@ -0,0 +1,109 @@
+#include "include/model_selection.h"
+#include "include/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+std::vector<ForecastCandidate> candidate_grid() {
+    std::vector<ForecastCandidate> grid;
+    for (double alpha : {0.3, 0.5, 0.7, 0.9}) {
+        for (double phi1 : {0.3, 0.5, 0.7}) {
+            for (double weight : {0.0, 0.5, 1.0}) grid.push_back(smoothing_blend_candidate(alpha, phi1, weight));
+        }
+    }
+    for (int order : {-1, 0, 1, 2, 3}) grid.push_back(ar_candidate(order));
+    grid.push_back(holt_winters_candidate(HoltWinters::Seasonality::None));
+    grid.push_back(holt_winters_candidate(HoltWinters::Seasonality::Additive));
+    grid.push_back(holt_winters_candidate(HoltWinters::Seasonality::Multiplicative));
+    grid.push_back(arima_candidate());
+    return grid;
+}
+
+ModelSelection select_model(const std::vector<double>& series, int first_month,
+                            const std::vector<ForecastCandidate>& grid, int horizon, unsigned threads) {
+    ModelSelection out;
+    const size_t n = series.size();
+    if (n < 8 || grid.empty()) return out;
+    // 保留最近四分之一（1..6 个月）作评估尾段，训练至少留 6 个月
+    const size_t tail = std::clamp<size_t>(n / 4, 1, 6);
+    const size_t first_origin = n - tail;
+    horizon = std::max(horizon, 1);
+
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> totals(grid.size(), inf);
+    std::vector<char> pruned(grid.size(), 0);
+    std::atomic<double> best_total{inf};
+    parallel_for(grid.size(), [&](size_t c) {
+        std::vector<double> mean, half;
+        double total = 0.0;
+        for (size_t t = first_origin; t < n; ++t) {
+            mean.clear();
+            half.clear();
+            grid[c].forecast(series.data(), t, first_month, horizon, mean, half);
+            for (int h = 0; h < horizon && t + h < n && h < static_cast<int>(mean.size()); ++h) {
+                const double actual = series[t + h], pred = mean[h];
+                const double denom = std::abs(pred) + std::abs(actual);
+                if (denom > 1e-9) total += 2.0 * std::abs(pred - actual) / denom;
+            }
+            if (!std::isfinite(total) || total > best_total.load(std::memory_order_relaxed)) {
+                pruned[c] = 1;
+                return;
+            }
+        }
+        totals[c] = total;
+        double cur = best_total.load(std::memory_order_relaxed);
+        while (total < cur && !best_total.compare_exchange_weak(cur, total, std::memory_order_relaxed)) {}
+    }, threads);
+
+    // 误差并列时取网格中靠前者
+    size_t best = grid.size();
+    for (size_t c = 0; c < grid.size(); ++c) {
+        if (pruned[c]) continue;
+        if (best == grid.size() || totals[c] < totals[best]) best = c;
+    }
+    if (best == grid.size()) return out;
+    // 评分点数：每个起点评估 min(horizon, 剩余长度) 步
+    size_t points = 0;
+    for (size_t t = first_origin; t < n; ++t) points += std::min<size_t>(horizon, n - t);
+    out.selected = true;
+    out.model = grid[best];
+    out.index = best;
+    out.score = points ? 100.0 * totals[best] / points : 0.0;
+    out.tail = tail;
+    return out;
+}
+
+nlohmann::json ModelSelection::to_json() const {
+    nlohmann::json j;
+    j["selected"] = selected;
+    if (!selected) return j;
+    j["family"] = model.name;
+    j["params"] = model.params;
+    j["holdout_smape"] = score;
+    j["holdout_months"] = tail;
+    return j;
+}
+
+nlohmann::json ModelSelection::state() const {
+    if (!selected) return nullptr;
+    return {{"index", index}, {"family", model.name}, {"params", model.params}, {"score", score}, {"tail", tail}};
+}
+
+bool ModelSelection::restore(const nlohmann::json& j, const std::vector<ForecastCandidate>& grid) {
+    ModelSelection loaded;
+    try {
+        if (!j.is_object()) return false;
+        loaded.index = j.at("index").get<size_t>();
+        loaded.score = j.at("score").get<double>();
+        loaded.tail = j.at("tail").get<size_t>();
+        if (loaded.index >= grid.size() || grid[loaded.index].name != j.at("family").get<std::string>() ||
+            grid[loaded.index].params != j.at("params")) return false;
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+    loaded.selected = true;
+    loaded.model = grid[loaded.index];
+    *this = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,78 @@
+#include "include/optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+OptimizeResult nelder_mead_bounded(const std::function<double(const std::vector<double>&)>& objective,
+                                   std::vector<double> start,
+                                   const std::vector<double>& lower,
+                                   const std::vector<double>& upper,
+                                   int max_evaluations,
+                                   double tolerance) {
+    const size_t dim = start.size();
+    OptimizeResult best;
+    auto project = [&](std::vector<double>& x) {
+        for (size_t i = 0; i < dim; ++i) x[i] = std::clamp(x[i], lower[i], upper[i]);
+    };
+    auto eval = [&](std::vector<double>& x) {
+        project(x);
+        best.evaluations++;
+        double v = objective(x);
+        return std::isfinite(v) ? v : 1e300;
+    };
+    project(start);
+    // 初始单纯形：每维偏移区间宽度的 10%，碰到上界则反向
+    std::vector<std::vector<double>> simplex(dim + 1, start);
+    std::vector<double> values(dim + 1);
+    for (size_t i = 0; i < dim; ++i) {
+        double step = 0.1 * (upper[i] - lower[i]);
+        simplex[i + 1][i] += (simplex[i + 1][i] + step <= upper[i]) ? step : -step;
+    }
+    for (size_t i = 0; i <= dim; ++i) values[i] = eval(simplex[i]);
+
+    std::vector<size_t> order(dim + 1);
+    std::vector<double> centroid(dim), trial(dim), trial2(dim);
+    while (best.evaluations < max_evaluations) {
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+        const size_t lo = order.front(), hi = order.back(), second = order[dim - 1];
+        if (std::abs(values[hi] - values[lo]) <= tolerance * (std::abs(values[lo]) + 1e-12)) break;
+        std::fill(centroid.begin(), centroid.end(), 0.0);
+        for (size_t i = 0; i <= dim; ++i) {
+            if (i == hi) continue;
+            for (size_t d = 0; d < dim; ++d) centroid[d] += simplex[i][d] / dim;
+        }
+        // 反射
+        for (size_t d = 0; d < dim; ++d) trial[d] = centroid[d] + (centroid[d] - simplex[hi][d]);
+        double fr = eval(trial);
+        if (fr < values[lo]) {
+            // 扩张
+            for (size_t d = 0; d < dim; ++d) trial2[d] = centroid[d] + 2.0 * (centroid[d] - simplex[hi][d]);
+            double fe = eval(trial2);
+            if (fe < fr) { simplex[hi] = trial2; values[hi] = fe; }
+            else { simplex[hi] = trial; values[hi] = fr; }
+        } else if (fr < values[second]) {
+            simplex[hi] = trial;
+            values[hi] = fr;
+        } else {
+            // 收缩
+            for (size_t d = 0; d < dim; ++d) trial2[d] = centroid[d] + 0.5 * (simplex[hi][d] - centroid[d]);
+            double fc = eval(trial2);
+            if (fc < values[hi]) {
+                simplex[hi] = trial2;
+                values[hi] = fc;
+            } else {
+                // 整体向最优点缩小
+                for (size_t i = 0; i <= dim; ++i) {
+                    if (i == lo) continue;
+                    for (size_t d = 0; d < dim; ++d) simplex[i][d] = simplex[lo][d] + 0.5 * (simplex[i][d] - simplex[lo][d]);
+                    values[i] = eval(simplex[i]);
+                }
+            }
+        }
+    }
+    size_t arg = std::min_element(values.begin(), values.end()) - values.begin();
+    best.x = simplex[arg];
+    best.value = values[arg];
+    return best;
+}
@@ -0,0 +1,40 @@
+#include "include/quantile.h"
+#include <algorithm>
+#include <cmath>
+
+// 递归多点选择：ks 为 [lo,hi) 内升序且去重的目标下标
+// 先定位中间的目标下标，再分别在左右两段中处理剩余下标
+static void multi_select(std::vector<double>& d, size_t lo, size_t hi, const size_t* kb, const size_t* ke) {
+    if (kb >= ke || hi - lo < 2) return;
+    const size_t* mid = kb + (ke - kb) / 2;
+    size_t k = *mid;
+    std::nth_element(d.begin() + lo, d.begin() + k, d.begin() + hi);
+    multi_select(d, lo, k, kb, mid);
+    multi_select(d, k + 1, hi, mid + 1, ke);
+}
+
+std::vector<double> select_quantiles(std::vector<double>& data, const std::vector<double>& ps) {
+    std::vector<double> result(ps.size(), 0.0);
+    if (data.empty()) return result;
+    const size_t n = data.size();
+    // 线性插值位置 pos = p*(n-1)，需要 floor 与 ceil 两个次序统计量
+    std::vector<double> pos(ps.size());
+    std::vector<size_t> ks;
+    ks.reserve(ps.size() * 2);
+    for (size_t i = 0; i < ps.size(); ++i) {
+        double p = std::isnan(ps[i]) ? 0.5 : std::clamp(ps[i], 0.0, 1.0);
+        pos[i] = p * (n - 1);
+        size_t lo = static_cast<size_t>(std::floor(pos[i]));
+        ks.push_back(lo);
+        if (lo + 1 < n && pos[i] > lo) ks.push_back(lo + 1);
+    }
+    std::sort(ks.begin(), ks.end());
+    ks.erase(std::unique(ks.begin(), ks.end()), ks.end());
+    multi_select(data, 0, n, ks.data(), ks.data() + ks.size());
+    for (size_t i = 0; i < ps.size(); ++i) {
+        size_t lo = static_cast<size_t>(std::floor(pos[i]));
+        double frac = pos[i] - lo;
+        result[i] = (frac > 0 && lo + 1 < n) ? data[lo] + frac * (data[lo + 1] - data[lo]) : data[lo];
+    }
+    return result;
+}
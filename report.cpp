@@ -14,6 +14,7 @@ static std::string str_replace_all(std::string s, const std::string& from, const
 #include "include/i18n.h"
 #include <fstream>
 #include <iomanip>
+#include <cmath>
 #include <ctime>
 #include <numeric>
 #include <algorithm>
@@ -36,55 +37,62 @@ static std::string sentiment_analysis(const std::string& remark) {
 }
 
 // 国际化文本报告生成
-void generate_report_i18n(const std::vector<Record>& records, const Stats& global_stats, const std::map<std::string, Stats>& type_stats, const std::map<std::string, Stats>& product_stats, const std::map<std::string, Stats>& country_stats, const std::map<std::string, Stats>& monthly_stats, const std::map<std::string, Stats>& unit_price_stats, const I18N& i18n, const std::string& filename) {
+void generate_report_i18n(const std::vector<Record>& records, const Stats& global_stats, const std::map<std::string, TypeStats>& type_stats, const std::map<std::string, CountryStats>& country_stats, const std::map<std::string, MonthlyStats>& monthly_stats, const I18N& i18n, const std::string& filename, const std::vector<double>* weights) {
     std::ofstream report(filename);
+    auto weight = [&](size_t i) { return weights ? (*weights)[i] : 1.0; };
+    double population = 0.0;
+    for (size_t i = 0; i < records.size(); ++i) population += weight(i);
     time_t now = time(nullptr);
     tm* now_tm = localtime(&now);
     report << "==================== " << i18n.t("report_title") << " ====================\n";
     report << i18n.t("analysis_time") << ": " << std::put_time(now_tm, "%Y-%m-%d %H:%M:%S") << "\n";
-    report << i18n.t("total_records") << ": " << records.size() << "\n";
+    report << i18n.t("total_records") << ": " << std::llround(population) << "\n";
     report << i18n.t("total_amount") << ": " << std::fixed << std::setprecision(2) << global_stats.total << " " << i18n.t("yuan") << "\n";
-    report << i18n.t("avg_amount") << ": " << global_stats.avg << " " << i18n.t("yuan") << "\n";
+    report << i18n.t("avg_amount") << ": " << global_stats.avg() << " " << i18n.t("yuan") << "\n";
     report << i18n.t("min_amount") << ": " << global_stats.min << " " << i18n.t("yuan") << "\n";
     report << i18n.t("max_amount") << ": " << global_stats.max << " " << i18n.t("yuan") << "\n";
     report << i18n.t("median_amount") << ": " << global_stats.median() << " " << i18n.t("yuan") << "\n";
     report << i18n.t("stddev_amount") << ": " << global_stats.std_dev() << " " << i18n.t("yuan") << " (" << i18n.t("volatility") << ")\n\n";
     // 按类别统计
     report << "==================== " << i18n.t("category_analysis") << " ====================\n";
-    std::vector<std::pair<std::string, Stats>> sorted_types(type_stats.begin(), type_stats.end());
+    std::vector<std::pair<std::string, TypeStats>> sorted_types(type_stats.begin(), type_stats.end());
     std::sort(sorted_types.begin(), sorted_types.end(), [](const auto& a, const auto& b) { return a.second.total > b.second.total; });
     for (const auto& [type, stat] : sorted_types) {
         report << "[" << type << "]\n";
         report << "  " << i18n.t("total") << ": " << stat.total << " " << i18n.t("yuan") << " (" << std::fixed << std::setprecision(1) << (stat.total * 100.0 / global_stats.total) << "%)\n";
         report << "  " << i18n.t("count") << ": " << stat.count << "\n";
-        report << "  " << i18n.t("avg") << ": " << stat.avg << " " << i18n.t("per_time") << "\n";
+        report << "  " << i18n.t("avg") << ": " << stat.avg() << " " << i18n.t("per_time") << "\n";
         report << "  " << i18n.t("range") << ": " << stat.min << " - " << stat.max << " " << i18n.t("yuan") << "\n\n";
     }
     // 消费模式识别
-    int blacklist_count = 0, imported_count = 0;
+    // 计数与金额均按记录权重累计（非抽样模式权重为 1）
+    double blacklist_weight = 0.0, imported_weight = 0.0;
     double blacklist_total = 0.0, imported_total = 0.0;
     std::vector<std::string> blacklist_products;
-    std::map<std::string, int> weekday_count, sentiment_count;
+    std::map<std::string, double> weekday_count, sentiment_count;
     std::map<std::string, double> weekday_amount;
-    for (const auto& r : records) {
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& r = records[i];
+        const double w = weight(i);
         if (r.is_blacklist) {
-            blacklist_count++;
-            blacklist_total += r.amount;
+            blacklist_weight += w;
+            blacklist_total += w * r.amount;
             blacklist_products.push_back(r.product_name);
         }
         if (r.is_imported) {
-            imported_count++;
-            imported_total += r.amount;
+            imported_weight += w;
+            imported_total += w * r.amount;
         }
         std::string weekday = extract_weekday(r);
-        weekday_count[weekday]++;
-        weekday_amount[weekday] += r.amount;
+        weekday_count[weekday] += w;
+        weekday_amount[weekday] += w * r.amount;
         std::string sentiment = sentiment_analysis(r.remark);
-        sentiment_count[sentiment]++;
+        sentiment_count[sentiment] += w;
     }
+    const long long blacklist_count = std::llround(blacklist_weight), imported_count = std::llround(imported_weight);
     report << "==================== " << i18n.t("pattern_analysis") << " ====================\n";
     report << "1. " << i18n.t("blacklist_analysis") << ":\n";
-    report << "   - " << i18n.t("blacklist_count") << ": " << blacklist_count << " " << i18n.t("item") << " (" << std::fixed << std::setprecision(1) << (blacklist_count * 100.0 / records.size()) << "%)\n";
+    report << "   - " << i18n.t("blacklist_count") << ": " << blacklist_count << " " << i18n.t("item") << " (" << std::fixed << std::setprecision(1) << (blacklist_weight * 100.0 / population) << "%)\n";
     report << "   - " << i18n.t("blacklist_total") << ": " << blacklist_total << " " << i18n.t("yuan") << "\n";
     if (!blacklist_products.empty()) {
         report << "   - " << i18n.t("blacklist_main") << ": ";
@@ -103,7 +111,7 @@ void generate_report_i18n(const std::vector<Record>& records, const Stats& globa
             // 替换 {weekday} {count} {total} {avg}
             size_t pos;
             while ((pos = line.find("{weekday}")) != std::string::npos) line.replace(pos, 9, day);
-            while ((pos = line.find("{count}")) != std::string::npos) line.replace(pos, 7, std::to_string(weekday_count[day]));
+            while ((pos = line.find("{count}")) != std::string::npos) line.replace(pos, 7, std::to_string(std::llround(weekday_count[day])));
             while ((pos = line.find("{total}")) != std::string::npos) line.replace(pos, 7, std::to_string(weekday_amount[day]));
             while ((pos = line.find("{avg}")) != std::string::npos) line.replace(pos, 5, std::to_string(weekday_amount[day] / weekday_count[day]));
             report << "   - " << line << "\n";
@@ -114,16 +122,16 @@ void generate_report_i18n(const std::vector<Record>& records, const Stats& globa
         std::string key = (sentiment == "负面") ? "sentiment_negative" : "sentiment_neutral";
         std::string tpl = i18n.t(key + "_stats");
         std::string line = tpl;
-        double percent = count * 100.0 / records.size();
+        double percent = count * 100.0 / population;
         size_t pos;
-        while ((pos = line.find("{count}")) != std::string::npos) line.replace(pos, 7, std::to_string(count));
+        while ((pos = line.find("{count}")) != std::string::npos) line.replace(pos, 7, std::to_string(std::llround(count)));
         while ((pos = line.find("{percent}")) != std::string::npos) line.replace(pos, 9, std::to_string(percent));
         report << "   - " << i18n.t(key) << ": " << line << "\n";
     }
     // 月度趋势分析
     if (monthly_stats.size() > 1) {
         report << "\n==================== " << i18n.t("monthly_trend") << " ====================\n";
-        std::vector<std::pair<std::string, Stats>> monthly_sorted(monthly_stats.begin(), monthly_stats.end());
+        std::vector<std::pair<std::string, MonthlyStats>> monthly_sorted(monthly_stats.begin(), monthly_stats.end());
         std::sort(monthly_sorted.begin(), monthly_sorted.end());
         for (size_t i = 0; i < monthly_sorted.size(); i++) {
             const auto& [month, stat] = monthly_sorted[i];
@@ -134,11 +142,12 @@ void generate_report_i18n(const std::vector<Record>& records, const Stats& globa
                 report << " | MoM: " << (change >= 0 ? "+" : "") << std::fixed << std::setprecision(1) << change << "%";
             }
             std::map<std::string, double> type_contrib;
-            for (const auto& r : records) {
+            for (size_t j = 0; j < records.size(); ++j) {
+                const Record& r = records[j];
                 std::ostringstream oss;
                 oss << std::put_time(&r.time_tm, "%Y-%m");
                 if (oss.str() == month) {
-                    type_contrib[r.type] += r.amount;
+                    type_contrib[r.type] += weight(j) * r.amount;
                 }
             }
             if (!type_contrib.empty()) {
@@ -161,8 +170,12 @@ void generate_report_i18n(const std::vector<Record>& records, const Stats& globa
         report << "   - " << line << "\n";
         report << "   - " << i18n.t("advice_blacklist_suggestion") << "\n";
     }
-    double luxury_threshold = global_stats.avg * 3;
-    int luxury_count = std::count_if(records.begin(), records.end(), [&](const Record& r) { return r.unit_price > luxury_threshold; });
+    double luxury_threshold = global_stats.avg() * 3;
+    double luxury_weight = 0.0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i].unit_price > luxury_threshold) luxury_weight += weight(i);
+    }
+    const long long luxury_count = std::llround(luxury_weight);
     if (luxury_count > 0) {
         std::string line = i18n.t("advice_luxury_count");
         line = str_replace_all(line, "{count}", std::to_string(luxury_count));
@@ -0,0 +1,117 @@
+#include "include/rolling_window.h"
+#include "include/date_util.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <numeric>
+
+RollingWindowEngine::RollingWindowEngine(std::vector<int> windows) : window_sizes(std::move(windows)) {
+    window_sizes.erase(std::remove_if(window_sizes.begin(), window_sizes.end(), [](int w) { return w <= 0; }), window_sizes.end());
+}
+
+// 单个窗口的滑动状态
+struct WindowState {
+    int w;
+    double sum = 0.0;
+    double sumsq = 0.0; // 以 shift 平移后的平方和，减少大数相消
+    std::deque<size_t> min_q, max_q; // 单调队列，存下标
+};
+
+std::vector<std::vector<RollingPoint>> RollingWindowEngine::compute(const std::vector<double>& series) const {
+    std::vector<std::vector<RollingPoint>> out(window_sizes.size());
+    const size_t n = series.size();
+    if (n == 0) return out;
+    const double shift = std::accumulate(series.begin(), series.end(), 0.0) / n;
+    std::vector<WindowState> states;
+    for (size_t k = 0; k < window_sizes.size(); ++k) {
+        states.push_back({window_sizes[k]});
+        if ((size_t)window_sizes[k] <= n) out[k].reserve(n - window_sizes[k] + 1);
+    }
+    for (size_t t = 0; t < n; ++t) {
+        const double x = series[t];
+        const double xs = x - shift;
+        for (size_t k = 0; k < states.size(); ++k) {
+            WindowState& s = states[k];
+            const size_t w = s.w;
+            s.sum += xs;
+            s.sumsq += xs * xs;
+            if (t >= w) {
+                const double old = series[t - w] - shift;
+                s.sum -= old;
+                s.sumsq -= old * old;
+            }
+            while (!s.min_q.empty() && series[s.min_q.back()] >= x) s.min_q.pop_back();
+            s.min_q.push_back(t);
+            while (!s.max_q.empty() && series[s.max_q.back()] <= x) s.max_q.pop_back();
+            s.max_q.push_back(t);
+            if (t + 1 < w) continue;
+            while (s.min_q.front() + w <= t) s.min_q.pop_front();
+            while (s.max_q.front() + w <= t) s.max_q.pop_front();
+            RollingPoint p;
+            p.mean = s.sum / w + shift;
+            p.sum = p.mean * w;
+            double var = w > 1 ? (s.sumsq - s.sum * s.sum / w) / (w - 1) : 0.0;
+            p.std_dev = var > 0 ? std::sqrt(var) : 0.0;
+            p.min = series[s.min_q.front()];
+            p.max = series[s.max_q.front()];
+            out[k].push_back(p);
+        }
+    }
+    return out;
+}
+
+nlohmann::json RollingWindowEngine::to_json(const DailySeries& series) const {
+    nlohmann::json j = nlohmann::json::object();
+    auto rolled = compute(series.values);
+    for (size_t k = 0; k < window_sizes.size(); ++k) {
+        if (rolled[k].empty()) continue;
+        nlohmann::json wj;
+        wj["start_date"] = format_day(series.first_day + window_sizes[k] - 1);
+        std::vector<double> sum, mean, sd, mn, mx;
+        for (const auto& p : rolled[k]) {
+            sum.push_back(p.sum);
+            mean.push_back(p.mean);
+            sd.push_back(p.std_dev);
+            mn.push_back(p.min);
+            mx.push_back(p.max);
+        }
+        wj["sum"] = sum;
+        wj["mean"] = mean;
+        wj["std"] = sd;
+        wj["min"] = mn;
+        wj["max"] = mx;
+        j[std::to_string(window_sizes[k])] = wj;
+    }
+    return j;
+}
+
+void build_daily_series(const std::vector<Record>& records, DailySeries& total, std::map<std::string, DailySeries>& by_category,
+                        const std::vector<double>* weights) {
+    int first = std::numeric_limits<int>::max(), last = std::numeric_limits<int>::min();
+    for (const auto& r : records) {
+        if (!valid_date(r.time_tm)) continue;
+        int d = day_index(r.time_tm);
+        first = std::min(first, d);
+        last = std::max(last, d);
+    }
+    total = DailySeries();
+    by_category.clear();
+    if (first > last) return;
+    const size_t len = static_cast<size_t>(last - first + 1);
+    total.first_day = first;
+    total.values.assign(len, 0.0);
+    for (size_t k = 0; k < records.size(); ++k) {
+        const Record& r = records[k];
+        if (!valid_date(r.time_tm)) continue;
+        size_t i = static_cast<size_t>(day_index(r.time_tm) - first);
+        const double amount = weights ? (*weights)[k] * r.amount : r.amount;
+        total.values[i] += amount;
+        DailySeries& cat = by_category[r.type];
+        if (cat.values.empty()) {
+            cat.first_day = first;
+            cat.values.assign(len, 0.0);
+        }
+        cat.values[i] += amount;
+    }
+}
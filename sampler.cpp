@@ -0,0 +1,254 @@
+#include "include/sampler.h"
+#include "include/date_util.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+StratifiedSampler::StratifiedSampler(size_t per_stratum, uint64_t seed) : capacity(per_stratum), rng(seed) {}
+
+static std::string record_month(const Record& r) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%04d-%02d", (r.time_tm.tm_year + 1900) % 10000, (r.time_tm.tm_mon + 1) % 100);
+    return buf;
+}
+
+void StratifiedSampler::offer(Record&& record) {
+    population_size++;
+    std::string month = record_month(record);
+    Stratum& s = strata[record.type + '\x1f' + month];
+    if (s.seen == 0) {
+        s.type = record.type;
+        s.month = month;
+        s.reservoir.reserve(capacity);
+    }
+    s.seen++;
+    if (s.reservoir.size() < capacity) {
+        s.reservoir.push_back(std::move(record));
+        return;
+    }
+    std::uniform_int_distribution<size_t> pick(0, s.seen - 1);
+    size_t j = pick(rng);
+    if (j < capacity) s.reservoir[j] = std::move(record);
+}
+
+size_t StratifiedSampler::sample_size() const {
+    size_t n = 0;
+    for (const auto& kv : strata) n += kv.second.reservoir.size();
+    return n;
+}
+
+std::vector<Record> StratifiedSampler::sample(std::vector<double>* weights) const {
+    std::vector<std::pair<const Record*, double>> picked;
+    picked.reserve(sample_size());
+    for (const auto& kv : strata) {
+        const double w = expansion(kv.second);
+        for (const auto& r : kv.second.reservoir) picked.emplace_back(&r, w);
+    }
+    std::stable_sort(picked.begin(), picked.end(), [](const auto& a, const auto& b) { return a.first->time < b.first->time; });
+    std::vector<Record> out;
+    out.reserve(picked.size());
+    if (weights) weights->clear();
+    for (const auto& [r, w] : picked) {
+        out.push_back(*r);
+        if (weights) weights->push_back(w);
+    }
+    return out;
+}
+
+double StratifiedSampler::expansion(const Stratum& s) const {
+    return s.reservoir.empty() ? 0.0 : static_cast<double>(s.seen) / s.reservoir.size();
+}
+
+// 单层贡献：N_h * 样本均值，方差 N_h^2 (1 - n_h/N_h) s_h^2 / n_h
+void StratifiedSampler::accumulate(const Stratum& s, Estimate& e) const {
+    const size_t n = s.reservoir.size();
+    if (n == 0) return;
+    const double N = static_cast<double>(s.seen);
+    double mean = 0.0;
+    for (const auto& r : s.reservoir) mean += r.amount;
+    mean /= n;
+    double s2 = 0.0;
+    for (const auto& r : s.reservoir) s2 += (r.amount - mean) * (r.amount - mean);
+    s2 = n > 1 ? s2 / (n - 1) : 0.0;
+    e.total += N * mean;
+    e.variance += N * N * (1.0 - n / N) * s2 / n;
+    e.population += s.seen;
+    e.sample += n;
+}
+
+template <typename DomainsOf>
+std::vector<StratifiedSampler::Estimate> StratifiedSampler::estimate_domains(size_t count, DomainsOf domains_of) const {
+    std::vector<Estimate> out(count);
+    std::unordered_map<size_t, std::array<double, 3>> acc; // 域 -> {z 之和, z^2 之和, 样本条数}
+    std::vector<size_t> ids;
+    for (const auto& kv : strata) {
+        const Stratum& s = kv.second;
+        const size_t n = s.reservoir.size();
+        if (n == 0) continue;
+        acc.clear();
+        for (const auto& r : s.reservoir) {
+            ids.clear();
+            domains_of(r, ids);
+            for (size_t d : ids) {
+                auto& a = acc[d];
+                a[0] += r.amount;
+                a[1] += r.amount * r.amount;
+                a[2] += 1.0;
+            }
+        }
+        // 域外样本 z = 0：层内均值为 和/n，方差按全部 n 条计
+        const double N = static_cast<double>(s.seen);
+        for (const auto& [d, a] : acc) {
+            const double s2 = n > 1 ? std::max(0.0, a[1] - a[0] * a[0] / n) / (n - 1) : 0.0;
+            Estimate& e = out[d];
+            e.total += N * a[0] / n;
+            e.variance += N * N * (1.0 - n / N) * s2 / n;
+            e.population += static_cast<size_t>(std::llround(N * a[2] / n));
+            e.sample += static_cast<size_t>(a[2]);
+        }
+    }
+    return out;
+}
+
+StratifiedSampler::Estimate StratifiedSampler::estimate_total() const {
+    Estimate e;
+    for (const auto& kv : strata) accumulate(kv.second, e);
+    return e;
+}
+
+std::map<std::string, StratifiedSampler::Estimate> StratifiedSampler::estimate_by_type() const {
+    std::map<std::string, Estimate> out;
+    for (const auto& kv : strata) accumulate(kv.second, out[kv.second.type]);
+    return out;
+}
+
+std::map<std::string, StratifiedSampler::Estimate> StratifiedSampler::estimate_by_month() const {
+    std::map<std::string, Estimate> out;
+    for (const auto& kv : strata) accumulate(kv.second, out[kv.second.month]);
+    return out;
+}
+
+static nlohmann::json estimate_json(double value, double variance, size_t population, size_t sample) {
+    double se = std::sqrt(std::max(variance, 0.0));
+    return {
+        {"estimate", value},
+        {"std_error", se},
+        {"ci95", {value - 1.96 * se, value + 1.96 * se}},
+        {"population", population},
+        {"sample", sample}
+    };
+}
+
+void StratifiedSampler::apply(AnalysisResult& result, std::map<std::string, TypeStats>& type_stats, std::map<std::string, CountryStats>& country_stats,
+                              std::map<std::string, MonthlyStats>& monthly_stats, Stats& global_stats, const GroupedSeries* series) const {
+    Estimate total = estimate_total();
+    auto by_type = estimate_by_type();
+    auto by_month = estimate_by_month();
+    const double N = static_cast<double>(total.population);
+
+    result.total_records = total.population;
+    result.total_amount = total.total;
+    result.avg_amount = N > 0 ? total.total / N : 0.0;
+    global_stats.total = total.total;
+    global_stats.count = static_cast<int>(total.population);
+
+    nlohmann::json j;
+    j["mode"] = "stratified_reservoir";
+    j["strata"] = strata.size();
+    j["per_stratum"] = capacity;
+    j["population"] = total.population;
+    j["sample_size"] = total.sample;
+    j["estimates"]["total_amount"] = estimate_json(total.total, total.variance, total.population, total.sample);
+    j["estimates"]["avg_amount"] = estimate_json(result.avg_amount, N > 0 ? total.variance / (N * N) : 0.0, total.population, total.sample);
+    for (const auto& [type, e] : by_type) {
+        result.category_total[type] = e.total;
+        type_stats[type].total = e.total;
+        type_stats[type].count = static_cast<int>(e.population);
+        j["estimates"]["category_total"][type] = estimate_json(e.total, e.variance, e.population, e.sample);
+    }
+    for (const auto& [month, e] : by_month) {
+        auto it = monthly_stats.find(month);
+        if (it != monthly_stats.end()) {
+            it->second.total = e.total;
+            it->second.count = static_cast<int>(e.population);
+        }
+        j["estimates"]["monthly_total"][month] = estimate_json(e.total, e.variance, e.population, e.sample);
+    }
+    // 国家不是分层维度，用样本记录按所在层的放大系数加权求和（Horvitz-Thompson 点估计，不给区间）
+    std::map<std::string, std::pair<double, double>> by_country;
+    for (const auto& kv : strata) {
+        const double w = expansion(kv.second);
+        for (const auto& r : kv.second.reservoir) {
+            if (r.origin_country.empty()) continue;
+            auto& c = by_country[r.origin_country];
+            c.first += w * r.amount;
+            c.second += w;
+        }
+    }
+    for (const auto& [name, tc] : by_country) {
+        country_stats[name].total = tc.first;
+        country_stats[name].count = static_cast<int>(std::llround(tc.second));
+    }
+    // 每日总额：time_series / rolling_stats 的各点
+    int first_day = std::numeric_limits<int>::max(), last_day = std::numeric_limits<int>::min();
+    for (const auto& kv : strata) {
+        for (const auto& r : kv.second.reservoir) {
+            if (!valid_date(r.time_tm)) continue;
+            first_day = std::min(first_day, day_index(r.time_tm));
+            last_day = std::max(last_day, day_index(r.time_tm));
+        }
+    }
+    if (first_day <= last_day) {
+        auto daily = estimate_domains(last_day - first_day + 1, [&](const Record& r, std::vector<size_t>& ids) {
+            if (valid_date(r.time_tm)) ids.push_back(day_index(r.time_tm) - first_day);
+        });
+        nlohmann::json& dj = j["estimates"]["daily_total"] = nlohmann::json::object();
+        for (size_t d = 0; d < daily.size(); ++d) {
+            const Estimate& e = daily[d];
+            if (e.sample > 0) dj[format_day(first_day + static_cast<int>(d))] = estimate_json(e.total, e.variance, e.population, e.sample);
+        }
+    }
+    // 分组月度序列（forecasts / backtest 的输入）逐格区间
+    if (series && series->matrix.length > 0) {
+        const SeriesMatrix& m = series->matrix;
+        std::unordered_map<std::string, size_t> rows[3];
+        const char* group_names[3] = {"category", "product", "country"};
+        for (size_t i = 1; i < m.rows(); ++i) {
+            for (int g = 0; g < 3; ++g) {
+                if (series->groups[i] == group_names[g]) rows[g].emplace(m.names[i], i);
+            }
+        }
+        auto cells = estimate_domains(m.rows() * m.length, [&](const Record& r, std::vector<size_t>& ids) {
+            if (!valid_date(r.time_tm)) return;
+            const int col = (r.time_tm.tm_year + 1900) * 12 + r.time_tm.tm_mon - series->first_month;
+            if (col < 0 || col >= static_cast<int>(m.length)) return;
+            ids.push_back(col);
+            const std::string* keys[3] = {&r.type, &r.product_name, &r.origin_country};
+            for (int g = 0; g < 3; ++g) {
+                auto it = rows[g].find(*keys[g]);
+                if (it != rows[g].end()) ids.push_back(it->second * m.length + col);
+            }
+        });
+        nlohmann::json& sj = j["estimates"]["monthly_series"] = nlohmann::json::object();
+        for (size_t i = 0; i < m.rows(); ++i) {
+            nlohmann::json row = nlohmann::json::object();
+            for (size_t col = 0; col < m.length; ++col) {
+                const Estimate& e = cells[i * m.length + col];
+                if (e.sample > 0) row[format_month(series->first_month + static_cast<int>(col))] = estimate_json(e.total, e.variance, e.population, e.sample);
+            }
+            sj[series->groups[i]][m.names[i]] = std::move(row);
+        }
+    }
+    // 由加权（总体估计）序列得出的结果：序列本身的抽样误差见 estimates.daily_total / monthly_series，
+    // 预测区间只含模型误差
+    j["weighted"] = {"time_series", "rolling_stats", "seasonal_anomalies", "holt_winters", "model_selection", "ar_model",
+                     "arima", "monthly_predict", "daily_predict", "prediction_bands", "forecasts", "backtest"};
+    // 以下结果均在样本上计算，不做放大
+    j["sample_based"] = {"min_amount", "max_amount", "median_amount", "stddev_amount", "clusters", "anomalies",
+                         "anomaly_scores", "user_profiles", "association_rules", "sentiment_analysis",
+                         "amount_histogram", "amount_summary", "amount_quantiles", "category_quantiles",
+                         "feature_matrix", "grouped_anomalies", "lof_anomalies", "feature_clusters", "distinct_counts"};
+    result.extra_json["sampling"] = j;
+}
@@ -0,0 +1,63 @@
+#include "include/simd_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+namespace simd {
+
+static void sq_dist_scalar(const float* x, size_t begin, size_t n, float c, float* acc) {
+    for (size_t i = begin; i < n; ++i) {
+        const float t = x[i] - c;
+        acc[i] += t * t;
+    }
+}
+
+#ifdef SIMD_X86
+static void sq_dist_sse2(const float* x, size_t n, float c, float* acc) {
+    const __m128 vc = _mm_set1_ps(c);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 t = _mm_sub_ps(_mm_loadu_ps(x + i), vc);
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(t, t)));
+    }
+    sq_dist_scalar(x, i, n, c, acc);
+}
+
+__attribute__((target("avx2")))
+static void sq_dist_avx2(const float* x, size_t n, float c, float* acc) {
+    const __m256 vc = _mm256_set1_ps(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 t = _mm256_sub_ps(_mm256_loadu_ps(x + i), vc);
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(t, t)));
+    }
+    sq_dist_scalar(x, i, n, c, acc);
+}
+
+__attribute__((target("avx512f")))
+static void sq_dist_avx512(const float* x, size_t n, float c, float* acc) {
+    const __m512 vc = _mm512_set1_ps(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512 t = _mm512_sub_ps(_mm512_loadu_ps(x + i), vc);
+        _mm512_storeu_ps(acc + i, _mm512_add_ps(_mm512_loadu_ps(acc + i), _mm512_mul_ps(t, t)));
+    }
+    sq_dist_scalar(x, i, n, c, acc);
+}
+#endif
+
+void squared_distance_accumulate(const float* column, size_t n, float center, float* acc) {
+#ifdef SIMD_X86
+    switch (isa()) {
+        case Isa::Avx512: return sq_dist_avx512(column, n, center, acc);
+        case Isa::Avx2: return sq_dist_avx2(column, n, center, acc);
+        case Isa::Sse2: return sq_dist_sse2(column, n, center, acc);
+        default: break;
+    }
+#endif
+    sq_dist_scalar(column, 0, n, center, acc);
+}
+
+}
@@ -0,0 +1,263 @@
+#include "include/simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+namespace simd {
+
+static void merge_into(Reduction& a, const Reduction& b) {
+    a.sum += b.sum;
+    a.sumsq += b.sumsq;
+    a.min = std::min(a.min, b.min);
+    a.max = std::max(a.max, b.max);
+    a.count += b.count;
+}
+
+static inline bool bit_set(const uint64_t* bm, size_t i) {
+    return (bm[i >> 6] >> (i & 63)) & 1;
+}
+
+// 标量版本，同时用于各向量版本的尾部处理
+static Reduction reduce_scalar(const double* d, size_t begin, size_t n, const uint64_t* bm) {
+    Reduction r;
+    for (size_t i = begin; i < n; ++i) {
+        if (bm && !bit_set(bm, i)) continue;
+        double x = d[i];
+        r.sum += x;
+        r.sumsq += x * x;
+        r.min = std::min(r.min, x);
+        r.max = std::max(r.max, x);
+        r.count++;
+    }
+    return r;
+}
+
+static double sum_sq_dev_scalar(const double* d, size_t begin, size_t n, double c) {
+    double s = 0.0;
+    for (size_t i = begin; i < n; ++i) s += (d[i] - c) * (d[i] - c);
+    return s;
+}
+
+#ifdef SIMD_X86
+// 水平归约：把向量寄存器逐 lane 写出后合并
+template <size_t L>
+static Reduction lanes_to_reduction(const double* s, const double* q, const double* mn, const double* mx) {
+    Reduction r;
+    for (size_t l = 0; l < L; ++l) {
+        r.sum += s[l];
+        r.sumsq += q[l];
+        r.min = std::min(r.min, mn[l]);
+        r.max = std::max(r.max, mx[l]);
+    }
+    return r;
+}
+
+static Reduction reduce_sse2(const double* d, size_t n, const uint64_t* bm) {
+    const __m128d pinf = _mm_set1_pd(INFINITY), ninf = _mm_set1_pd(-INFINITY);
+    __m128d s = _mm_setzero_pd(), q = _mm_setzero_pd(), mn = pinf, mx = ninf;
+    size_t i = 0, count = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(d + i);
+        __m128d lo = x, hi = x;
+        if (bm) {
+            uint64_t bits = (bm[i >> 6] >> (i & 63)) & 0x3;
+            count += __builtin_popcountll(bits);
+            __m128d m = _mm_castsi128_pd(_mm_set_epi64x(-(int64_t)((bits >> 1) & 1), -(int64_t)(bits & 1)));
+            x = _mm_and_pd(m, x);
+            lo = _mm_or_pd(_mm_and_pd(m, lo), _mm_andnot_pd(m, pinf));
+            hi = _mm_or_pd(_mm_and_pd(m, hi), _mm_andnot_pd(m, ninf));
+        }
+        s = _mm_add_pd(s, x);
+        q = _mm_add_pd(q, _mm_mul_pd(x, x));
+        mn = _mm_min_pd(mn, lo);
+        mx = _mm_max_pd(mx, hi);
+    }
+    alignas(16) double vs[2], vq[2], vmn[2], vmx[2];
+    _mm_store_pd(vs, s); _mm_store_pd(vq, q); _mm_store_pd(vmn, mn); _mm_store_pd(vmx, mx);
+    Reduction r = lanes_to_reduction<2>(vs, vq, vmn, vmx);
+    r.count = bm ? count : i;
+    merge_into(r, reduce_scalar(d, i, n, bm));
+    return r;
+}
+
+__attribute__((target("avx2")))
+static Reduction reduce_avx2(const double* d, size_t n, const uint64_t* bm) {
+    const __m256d pinf = _mm256_set1_pd(INFINITY), ninf = _mm256_set1_pd(-INFINITY);
+    const __m256i lane_bits = _mm256_set_epi64x(8, 4, 2, 1);
+    __m256d s = _mm256_setzero_pd(), q = _mm256_setzero_pd(), mn = pinf, mx = ninf;
+    size_t i = 0, count = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(d + i);
+        __m256d lo = x, hi = x;
+        if (bm) {
+            // i 为 4 的倍数，4 位不会跨越 64 位字
+            uint64_t bits = (bm[i >> 6] >> (i & 63)) & 0xF;
+            count += __builtin_popcountll(bits);
+            __m256i sel = _mm256_and_si256(_mm256_set1_epi64x((long long)bits), lane_bits);
+            __m256d m = _mm256_castsi256_pd(_mm256_cmpeq_epi64(sel, lane_bits));
+            x = _mm256_and_pd(m, x);
+            lo = _mm256_blendv_pd(pinf, lo, m);
+            hi = _mm256_blendv_pd(ninf, hi, m);
+        }
+        s = _mm256_add_pd(s, x);
+        q = _mm256_add_pd(q, _mm256_mul_pd(x, x));
+        mn = _mm256_min_pd(mn, lo);
+        mx = _mm256_max_pd(mx, hi);
+    }
+    alignas(32) double vs[4], vq[4], vmn[4], vmx[4];
+    _mm256_store_pd(vs, s); _mm256_store_pd(vq, q); _mm256_store_pd(vmn, mn); _mm256_store_pd(vmx, mx);
+    Reduction r = lanes_to_reduction<4>(vs, vq, vmn, vmx);
+    r.count = bm ? count : i;
+    merge_into(r, reduce_scalar(d, i, n, bm));
+    return r;
+}
+
+__attribute__((target("avx512f")))
+static Reduction reduce_avx512(const double* d, size_t n, const uint64_t* bm) {
+    __m512d s = _mm512_setzero_pd(), q = _mm512_setzero_pd();
+    __m512d mn = _mm512_set1_pd(INFINITY), mx = _mm512_set1_pd(-INFINITY);
+    size_t i = 0, count = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d x = _mm512_loadu_pd(d + i);
+        __mmask8 k = bm ? (__mmask8)((bm[i >> 6] >> (i & 63)) & 0xFF) : (__mmask8)0xFF;
+        count += __builtin_popcount(k);
+        s = _mm512_mask_add_pd(s, k, s, x);
+        q = _mm512_mask_add_pd(q, k, q, _mm512_mul_pd(x, x));
+        mn = _mm512_mask_min_pd(mn, k, mn, x);
+        mx = _mm512_mask_max_pd(mx, k, mx, x);
+    }
+    alignas(64) double vs[8], vq[8], vmn[8], vmx[8];
+    _mm512_store_pd(vs, s); _mm512_store_pd(vq, q); _mm512_store_pd(vmn, mn); _mm512_store_pd(vmx, mx);
+    Reduction r = lanes_to_reduction<8>(vs, vq, vmn, vmx);
+    r.count = count;
+    merge_into(r, reduce_scalar(d, i, n, bm));
+    return r;
+}
+
+static double sum_sq_dev_sse2(const double* d, size_t n, double c) {
+    const __m128d vc = _mm_set1_pd(c);
+    __m128d acc = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d t = _mm_sub_pd(_mm_loadu_pd(d + i), vc);
+        acc = _mm_add_pd(acc, _mm_mul_pd(t, t));
+    }
+    alignas(16) double v[2];
+    _mm_store_pd(v, acc);
+    return v[0] + v[1] + sum_sq_dev_scalar(d, i, n, c);
+}
+
+__attribute__((target("avx2,fma")))
+static double sum_sq_dev_avx2(const double* d, size_t n, double c) {
+    const __m256d vc = _mm256_set1_pd(c);
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d t0 = _mm256_sub_pd(_mm256_loadu_pd(d + i), vc);
+        __m256d t1 = _mm256_sub_pd(_mm256_loadu_pd(d + i + 4), vc);
+        a0 = _mm256_fmadd_pd(t0, t0, a0);
+        a1 = _mm256_fmadd_pd(t1, t1, a1);
+    }
+    alignas(32) double v[4];
+    _mm256_store_pd(v, _mm256_add_pd(a0, a1));
+    return v[0] + v[1] + v[2] + v[3] + sum_sq_dev_scalar(d, i, n, c);
+}
+
+__attribute__((target("avx512f")))
+static double sum_sq_dev_avx512(const double* d, size_t n, double c) {
+    const __m512d vc = _mm512_set1_pd(c);
+    __m512d acc = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d t = _mm512_sub_pd(_mm512_loadu_pd(d + i), vc);
+        acc = _mm512_fmadd_pd(t, t, acc);
+    }
+    alignas(64) double v[8];
+    _mm512_store_pd(v, acc);
+    double total = 0.0;
+    for (double x : v) total += x;
+    return total + sum_sq_dev_scalar(d, i, n, c);
+}
+#endif
+
+static Isa detect_isa() {
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::Avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Isa::Avx2;
+    return Isa::Sse2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+Isa isa() {
+    static const Isa detected = detect_isa();
+    return detected;
+}
+
+static Reduction dispatch_reduce(const double* d, size_t n, const uint64_t* bm) {
+#ifdef SIMD_X86
+    switch (isa()) {
+        case Isa::Avx512: return reduce_avx512(d, n, bm);
+        case Isa::Avx2: return reduce_avx2(d, n, bm);
+        case Isa::Sse2: return reduce_sse2(d, n, bm);
+        default: break;
+    }
+#endif
+    return reduce_scalar(d, 0, n, bm);
+}
+
+Reduction reduce(const double* data, size_t n) {
+    return dispatch_reduce(data, n, nullptr);
+}
+
+Reduction reduce_masked(const double* data, const uint64_t* bitmap, size_t n) {
+    return dispatch_reduce(data, n, bitmap);
+}
+
+double sum_sq_dev(const double* data, size_t n, double center) {
+#ifdef SIMD_X86
+    switch (isa()) {
+        case Isa::Avx512: return sum_sq_dev_avx512(data, n, center);
+        case Isa::Avx2: return sum_sq_dev_avx2(data, n, center);
+        case Isa::Sse2: return sum_sq_dev_sse2(data, n, center);
+        default: break;
+    }
+#endif
+    return sum_sq_dev_scalar(data, 0, n, center);
+}
+
+// 直方图的写入是随机访问，难以向量化；这里用 4 份子直方图交替累加，
+// 打断相邻元素落入同一桶时的写后读依赖，最后再合并
+std::vector<uint64_t> histogram(const double* data, size_t n, double lo, double hi, size_t bins) {
+    std::vector<uint64_t> out(bins, 0);
+    if (bins == 0 || n == 0) return out;
+    const double scale = hi > lo ? bins / (hi - lo) : 0.0;
+    const long last = static_cast<long>(bins) - 1;
+    std::vector<uint64_t> sub(bins * 4, 0);
+    for (size_t i = 0; i < n; ++i) {
+        double t = (data[i] - lo) * scale;
+        long b = !(t >= 0) ? 0 : (t >= last ? last : static_cast<long>(t));
+        sub[(i & 3) * bins + b]++;
+    }
+    for (size_t k = 0; k < 4; ++k) {
+        for (size_t b = 0; b < bins; ++b) out[b] += sub[k * bins + b];
+    }
+    return out;
+}
+
+const char* active_isa() {
+    switch (isa()) {
+        case Isa::Avx512: return "avx512";
+        case Isa::Avx2: return "avx2";
+        case Isa::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+}
@@ -1,79 +1,14 @@
 
 #include "include/stats.h"
 #include "include/record.h"
+#include "include/quantile.h"
 #include <numeric>
 #include <algorithm>
 #include <cmath>
 
-// 简单自回归(AR)模型实现
-void TimeSeriesForecaster::fit(const std::vector<double>& data, int order) {
-    ar_order = order;
-    train_data = data;
-    // 仅实现AR(1)最小二乘拟合
-    ar_coeffs.clear();
-    if ((int)data.size() <= order) return;
-    double num = 0.0, denom = 0.0;
-    for (size_t i = order; i < data.size(); ++i) {
-        num += data[i] * data[i-1];
-        denom += data[i-1] * data[i-1];
-    }
-    if (denom != 0)
-        ar_coeffs.push_back(num / denom);
-    else
-        ar_coeffs.push_back(0.0);
-}
-
-std::vector<double> TimeSeriesForecaster::predict(int steps) const {
-    std::vector<double> result;
-    if (train_data.empty() || ar_coeffs.empty()) return result;
-    double last = train_data.back();
-    for (int i = 0; i < steps; ++i) {
-        double pred = ar_coeffs[0] * last;
-        result.push_back(pred);
-        last = pred;
-    }
-    return result;
-}
-
-nlohmann::json TimeSeriesForecaster::to_json() const {
-    nlohmann::json j;
-    j["ar_order"] = ar_order;
-    j["ar_coeffs"] = ar_coeffs;
-    j["train_data"] = train_data;
-    return j;
-}
-
-void Stats::add_value(double value) {
-    total += value;
-    count++;
-    values.push_back(value);
-    avg = total / count;
-    if (value < min) min = value;
-    if (value > max) max = value;
-}
-
-double Stats::median() const {
-    if (values.empty()) return 0.0;
-    std::vector<double> sorted = values;
-    std::sort(sorted.begin(), sorted.end());
-    size_t n = sorted.size() / 2;
-    if (sorted.size() % 2 == 0) {
-        return (sorted[n-1] + sorted[n]) / 2.0;
-    }
-    return sorted[n];
-}
-
-double Stats::std_dev() const {
-    if (values.size() < 2) return 0.0;
-    double variance = 0.0;
-    for (double v : values) {
-        variance += pow(v - avg, 2);
-    }
-    return sqrt(variance / (values.size() - 1));
-}
-
-bool Stats::operator<(const Stats& other) const {
-    return total < other.total;
+std::vector<double> metric::Quantile::quantiles(const std::vector<double>& ps) const {
+    std::vector<double> work = values;
+    return select_quantiles(work, ps);
 }
 
 #include <ctime>
@@ -88,15 +23,63 @@ static std::string extract_month(const Record& record) {
     return oss.str();
 }
 
-void compute_stats(const std::vector<Record>& records, std::map<std::string, Stats>& type_stats, std::map<std::string, Stats>& product_stats, std::map<std::string, Stats>& country_stats, std::map<std::string, Stats>& monthly_stats, std::map<std::string, Stats>& unit_price_stats, Stats& global_stats) {
+static HyperLogLog& group_sketch(std::map<std::string, HyperLogLog>& groups, const std::string& key) {
+    auto it = groups.find(key);
+    if (it == groups.end()) it = groups.emplace(key, HyperLogLog(DistinctStats::GROUP_PRECISION)).first;
+    return it->second;
+}
+
+void DistinctStats::add(const Record& r, const std::string& month) {
+    // 每个值只哈希一次，各草图复用同一哈希
+    uint64_t product_hash = HyperLogLog::hash(r.product_name);
+    uint64_t type_hash = HyperLogLog::hash(r.type);
+    products.add_hash(product_hash);
+    categories.add_hash(type_hash);
+    group_sketch(products_per_month, month).add_hash(product_hash);
+    group_sketch(products_per_category, r.type).add_hash(product_hash);
+    if (!r.origin_country.empty()) {
+        countries.add(r.origin_country);
+        group_sketch(categories_per_country, r.origin_country).add_hash(type_hash);
+    }
+}
+
+void DistinctStats::merge(const DistinctStats& other) {
+    products.merge(other.products);
+    categories.merge(other.categories);
+    countries.merge(other.countries);
+    auto merge_groups = [](std::map<std::string, HyperLogLog>& dst, const std::map<std::string, HyperLogLog>& src) {
+        for (const auto& [key, sketch] : src) group_sketch(dst, key).merge(sketch);
+    };
+    merge_groups(products_per_month, other.products_per_month);
+    merge_groups(products_per_category, other.products_per_category);
+    merge_groups(categories_per_country, other.categories_per_country);
+}
+
+nlohmann::json DistinctStats::to_json() const {
+    nlohmann::json j;
+    j["products"] = products.to_json();
+    j["categories"] = categories.to_json();
+    j["countries"] = countries.to_json();
+    auto groups_json = [](const std::map<std::string, HyperLogLog>& groups) {
+        nlohmann::json g = nlohmann::json::object();
+        for (const auto& [key, sketch] : groups) g[key] = sketch.to_json();
+        return g;
+    };
+    j["products_per_month"] = groups_json(products_per_month);
+    j["products_per_category"] = groups_json(products_per_category);
+    j["categories_per_country"] = groups_json(categories_per_country);
+    return j;
+}
+
+void compute_stats(const std::vector<Record>& records, std::map<std::string, TypeStats>& type_stats, std::map<std::string, CountryStats>& country_stats, std::map<std::string, MonthlyStats>& monthly_stats, Stats& global_stats, DistinctStats* distinct_stats) {
     for (const auto& r : records) {
+        std::string month = extract_month(r);
         global_stats.add_value(r.amount);
         type_stats[r.type].add_value(r.amount);
-        product_stats[r.product_name].add_value(r.amount);
         if (!r.origin_country.empty()) {
             country_stats[r.origin_country].add_value(r.amount);
         }
-        monthly_stats[extract_month(r)].add_value(r.amount);
-        unit_price_stats[r.product_name].add_value(r.unit_price);
+        monthly_stats[month].add_value(r.amount);
+        if (distinct_stats) distinct_stats->add(r, month);
     }
 }
@@ -0,0 +1,189 @@
+#include "include/stl.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int next_odd(double x) {
+    int v = static_cast<int>(std::ceil(x));
+    return v % 2 == 0 ? v + 1 : v;
+}
+
+// 在位置 x 处做局部线性加权回归，[left, right] 为参与拟合的下标区间（含端点），w 为工作缓冲；
+// rw 为鲁棒权重（可空）。邻域内权重全为 0 时返回 false
+bool loess_point(const double* y, const double* rw, int n, int q, double x, int left, int right,
+                 std::vector<double>& w, double& out) {
+    double h = std::max(x - left, right - x);
+    if (q > n) h += (q - n) / 2;
+    const double h9 = 0.999 * h, h1 = 0.001 * h;
+    w.resize(right - left + 1);
+    double total = 0.0;
+    for (int j = left; j <= right; ++j) {
+        const double r = std::abs(j - x);
+        double wj = 0.0;
+        if (r <= h9) {
+            const double u = r <= h1 ? 0.0 : r / h;
+            const double t = 1.0 - u * u * u;
+            wj = t * t * t;
+            if (rw) wj *= rw[j];
+        }
+        w[j - left] = wj;
+        total += wj;
+    }
+    if (total <= 0.0) return false;
+    double a = 0.0;
+    for (int j = left; j <= right; ++j) a += (w[j - left] /= total) * j;
+    if (h > 0.0) {
+        double b = 0.0;
+        for (int j = left; j <= right; ++j) b += w[j - left] * (j - a) * (j - a);
+        if (std::sqrt(b) > 0.001 * (n - 1)) {
+            const double c = (x - a) / b;
+            for (int j = left; j <= right; ++j) w[j - left] *= 1.0 + c * (j - a);
+        }
+    }
+    out = 0.0;
+    for (int j = left; j <= right; ++j) out += w[j - left] * y[j];
+    return true;
+}
+
+// 窗口 q 的 LOESS 平滑：每隔 jump 个点求值，其余线性插值
+void loess_smooth(const double* y, const double* rw, int n, int q, std::vector<double>& w, double* out) {
+    if (n < 2) {
+        if (n == 1) out[0] = y[0];
+        return;
+    }
+    const int jump = std::max(1, std::min((q + 9) / 10, n - 1));
+    auto eval = [&](int i) {
+        int left = 0, right = n - 1;
+        if (q < n) {
+            left = std::clamp(i - q / 2, 0, n - q);
+            right = left + q - 1;
+        }
+        if (!loess_point(y, rw, n, q, i, left, right, w, out[i])) out[i] = y[i];
+    };
+    int prev = 0;
+    eval(0);
+    for (int i = jump; ; i += jump) {
+        const int cur = std::min(i, n - 1);
+        eval(cur);
+        const double slope = (out[cur] - out[prev]) / (cur - prev);
+        for (int j = prev + 1; j < cur; ++j) out[j] = out[prev] + slope * (j - prev);
+        prev = cur;
+        if (cur == n - 1) break;
+    }
+}
+
+// 滑动平均：输出 len - window + 1 个值
+void moving_average(const double* x, int len, int window, double* out) {
+    double sum = 0.0;
+    for (int i = 0; i < window; ++i) sum += x[i];
+    out[0] = sum / window;
+    for (int i = window; i < len; ++i) {
+        sum += x[i] - x[i - window];
+        out[i - window + 1] = sum / window;
+    }
+}
+
+double median_of(std::vector<double> v) {
+    const size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    return v[mid];
+}
+
+} // namespace
+
+void stl_decompose(const std::vector<double>& y, int period, const StlOptions& options,
+                   std::vector<double>& seasonal, std::vector<double>& trend) {
+    const int n = static_cast<int>(y.size());
+    seasonal.assign(n, 0.0);
+    trend = y;
+    if (period < 2 || n < 2 * period) return;
+    const int p = period;
+    const bool periodic = options.seasonal_window <= 0;
+    // periodic 时按 STL 的约定取很大的季节窗口，只影响趋势窗口的计算
+    const int ns = periodic ? 10 * n + 1 : std::max(7, next_odd(options.seasonal_window));
+    const int nl = next_odd(p);
+    const int nt = next_odd(1.5 * p / (1.0 - 1.5 / ns));
+    trend.assign(n, 0.0);
+
+    std::vector<double> rw(n, 1.0), detrended(n), cycle(n + 2 * p), low1(n + p + 1), low2(n + 2), low3(n), low(n);
+    std::vector<double> sub, sub_rw, sub_out, w;
+    for (int outer = 0; outer <= options.outer_iterations; ++outer) {
+        for (int inner = 0; inner < std::max(1, options.inner_iterations); ++inner) {
+            // 1. 去趋势
+            for (int i = 0; i < n; ++i) detrended[i] = y[i] - trend[i];
+            // 2. 周期子序列平滑，并向两端各外推一个周期：cycle[t + p] 对应时刻 t
+            for (int k = 0; k < p; ++k) {
+                const int m = (n - k + p - 1) / p;
+                sub.resize(m);
+                sub_rw.resize(m);
+                sub_out.resize(m);
+                for (int j = 0; j < m; ++j) { sub[j] = detrended[k + j * p]; sub_rw[j] = rw[k + j * p]; }
+                if (periodic) {
+                    double sw = 0.0, sy = 0.0;
+                    for (int j = 0; j < m; ++j) { sw += sub_rw[j]; sy += sub_rw[j] * sub[j]; }
+                    const double mean = sw > 0.0 ? sy / sw : 0.0;
+                    for (int j = 0; j <= m + 1; ++j) cycle[j * p + k] = mean;
+                    continue;
+                }
+                loess_smooth(sub.data(), sub_rw.data(), m, ns, w, sub_out.data());
+                for (int j = 0; j < m; ++j) cycle[(j + 1) * p + k] = sub_out[j];
+                const int q = std::min(ns, m);
+                double v;
+                cycle[k] = loess_point(sub.data(), sub_rw.data(), m, ns, -1, 0, q - 1, w, v) ? v : sub_out[0];
+                cycle[(m + 1) * p + k] = loess_point(sub.data(), sub_rw.data(), m, ns, m, m - q, m - 1, w, v) ? v : sub_out[m - 1];
+            }
+            // 3. 低通：MA(p) -> MA(p) -> MA(3) -> LOESS(nl)
+            moving_average(cycle.data(), n + 2 * p, p, low1.data());
+            moving_average(low1.data(), n + p + 1, p, low2.data());
+            moving_average(low2.data(), n + 2, 3, low3.data());
+            loess_smooth(low3.data(), nullptr, n, nl, w, low.data());
+            // 4. 季节项 = 平滑周期子序列 - 低通
+            for (int i = 0; i < n; ++i) seasonal[i] = cycle[i + p] - low[i];
+            // 5. 去季节后平滑得到趋势
+            for (int i = 0; i < n; ++i) detrended[i] = y[i] - seasonal[i];
+            loess_smooth(detrended.data(), rw.data(), n, nt, w, trend.data());
+        }
+        if (outer == options.outer_iterations) break;
+        // 鲁棒权重：双平方函数，尺度为 6 倍残差绝对值中位数
+        std::vector<double> abs_resid(n);
+        for (int i = 0; i < n; ++i) abs_resid[i] = std::abs(y[i] - trend[i] - seasonal[i]);
+        const double h = 6.0 * median_of(abs_resid);
+        for (int i = 0; i < n; ++i) {
+            const double u = h > 0.0 ? abs_resid[i] / h : 0.0;
+            rw[i] = u < 1.0 ? (1.0 - u * u) * (1.0 - u * u) : 0.0;
+        }
+    }
+}
+
+StlDecomposition mstl_decompose(const std::vector<double>& y, std::vector<int> periods, const StlOptions& options) {
+    StlDecomposition out;
+    const size_t n = y.size();
+    std::sort(periods.begin(), periods.end());
+    periods.erase(std::unique(periods.begin(), periods.end()), periods.end());
+    for (int p : periods) {
+        if (p >= 2 && n >= 2 * static_cast<size_t>(p)) out.periods.push_back(p);
+    }
+    out.trend = y;
+    out.seasonal.assign(out.periods.size(), std::vector<double>(n, 0.0));
+    out.residual.assign(n, 0.0);
+    if (out.periods.empty()) return out;
+
+    // 各周期的选项：季节窗口可按周期覆盖
+    std::vector<StlOptions> per_period(out.periods.size(), options);
+    for (size_t k = 0; k < out.periods.size(); ++k) {
+        auto it = options.period_windows.find(out.periods[k]);
+        if (it != options.period_windows.end()) per_period[k].seasonal_window = it->second;
+    }
+    // 逐个周期：把该周期上一轮的季节项加回，重新分解，再扣除；最终趋势取最后一次分解
+    std::vector<double> deseason = y;
+    for (int it = 0; it < std::max(1, options.mstl_iterations); ++it) {
+        for (size_t k = 0; k < out.periods.size(); ++k) {
+            for (size_t i = 0; i < n; ++i) deseason[i] += out.seasonal[k][i];
+            stl_decompose(deseason, out.periods[k], per_period[k], out.seasonal[k], out.trend);
+            for (size_t i = 0; i < n; ++i) deseason[i] -= out.seasonal[k][i];
+        }
+    }
+    for (size_t i = 0; i < n; ++i) out.residual[i] = deseason[i] - out.trend[i];
+    return out;
+}
@@ -0,0 +1,214 @@
+#include "include/stream_detector.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+constexpr uint64_t DIGEST_SEED = 14695981039346656037ull;
+
+uint64_t fnv1a(uint64_t h, const void* data, size_t n) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// 链式摘要：前一条的摘要接上本条的时间、类别、商品与金额
+uint64_t chain_digest(uint64_t h, const Record& r) {
+    for (const std::string* s : {&r.time, &r.type, &r.product_name}) h = fnv1a(h, s->data(), s->size() + 1);
+    return fnv1a(h, &r.amount, sizeof(r.amount));
+}
+
+double log_amount(const Record& r) {
+    return std::copysign(std::log1p(std::abs(r.amount)), r.amount);
+}
+
+} // namespace
+
+nlohmann::json StreamAlert::to_json() const {
+    return {{"sequence", sequence}, {"group", group}, {"key", key}, {"time", time}, {"remark", remark},
+            {"amount", amount}, {"expected", expected}, {"z", z}};
+}
+
+StreamingAnomalyDetector::StreamingAnomalyDetector(double half_life, double z_threshold, size_t warmup, size_t max_alerts)
+    : alpha(1.0 - std::pow(0.5, 1.0 / std::max(half_life, 1.0))), threshold(z_threshold), warmup(std::max<size_t>(warmup, 2)),
+      max_alerts(max_alerts), digest(DIGEST_SEED) {}
+
+bool StreamingAnomalyDetector::score_and_update(Ewma& s, double x, double& z, double& expected) const {
+    bool alert = false;
+    double sd = std::sqrt(s.var);
+    if (s.n >= warmup) {
+        // 方差下限：组内金额几乎恒定时，避免极小的波动被放大成高 z 值
+        const double floor_sd = std::max(sd, 0.05);
+        z = (x - s.mean) / floor_sd;
+        expected = std::expm1(s.mean);
+        alert = std::abs(z) > threshold;
+        x = std::clamp(x, s.mean - threshold * floor_sd, s.mean + threshold * floor_sd);
+    }
+    // 前若干条按算术平均起步，之后切换为固定衰减率
+    s.n++;
+    const double a = std::max(alpha, 1.0 / s.n);
+    const double diff = x - s.mean;
+    const double incr = a * diff;
+    s.mean += incr;
+    s.var = (1.0 - a) * (s.var + diff * incr);
+    return alert;
+}
+
+void StreamingAnomalyDetector::emit(StreamAlert&& alert) {
+    n_alerts++;
+    if (replay_until > 0) {
+        // 全量重跑的已处理部分：上次已发出，先暂存
+        if (pending.size() < max_alerts) pending.push_back(alert);
+        else pending_dropped++;
+    } else if (on_alert) {
+        on_alert(alert);
+    }
+    if (max_alerts == 0) return;
+    if (emitted.size() == max_alerts) emitted.pop_front();
+    emitted.push_back(std::move(alert));
+}
+
+void StreamingAnomalyDetector::end_replay(bool matched) {
+    if (!matched && on_alert) {
+        for (const auto& a : pending) on_alert(a);
+        if (pending_dropped > 0) {
+            std::cerr << "Warning: stream state does not match input; " << pending_dropped
+                      << " earlier alerts were not re-emitted" << std::endl;
+        }
+    }
+    replay_until = 0;
+    pending.clear();
+    pending.shrink_to_fit();
+    pending_dropped = 0;
+}
+
+size_t StreamingAnomalyDetector::observe(const Record& record) {
+    if (has_saved) {
+        has_saved = false;
+        if (chain_digest(DIGEST_SEED, record) == saved.first_digest) {
+            replay_until = saved.observed;
+            replay_digest = saved.digest;
+        } else {
+            by_category = std::move(saved.by_category);
+            by_product = std::move(saved.by_product);
+            n_seen = saved.observed;
+            n_alerts = saved.alerts;
+            digest = saved.digest;
+            first_digest = saved.first_digest;
+        }
+        saved = Snapshot();
+    }
+    digest = chain_digest(digest, record);
+    if (n_seen == 0) first_digest = digest;
+    const double x = log_amount(record);
+    size_t count = 0;
+    struct Target { const char* group; GroupMap* states; const std::string* key; };
+    const Target targets[] = {{"category", &by_category, &record.type}, {"product", &by_product, &record.product_name}};
+    for (const Target& t : targets) {
+        double z = 0.0, expected = 0.0;
+        if (!score_and_update((*t.states)[*t.key], x, z, expected)) continue;
+        StreamAlert alert;
+        alert.sequence = n_seen;
+        alert.group = t.group;
+        alert.key = *t.key;
+        alert.time = record.time;
+        alert.remark = record.remark;
+        alert.amount = record.amount;
+        alert.expected = expected;
+        alert.z = z;
+        emit(std::move(alert));
+        count++;
+    }
+    n_seen++;
+    if (replay_until > 0 && n_seen == replay_until) end_replay(digest == replay_digest);
+    return count;
+}
+
+void StreamingAnomalyDetector::finish() {
+    if (replay_until > 0) end_replay(false);
+}
+
+double StreamingAnomalyDetector::score(const Record& record) const {
+    const double x = log_amount(record);
+    double best = 0.0;
+    for (const auto& [states, key] : {std::pair{&by_category, &record.type}, std::pair{&by_product, &record.product_name}}) {
+        auto it = states->find(*key);
+        if (it == states->end() || it->second.n < warmup) continue;
+        const double sd = std::max(std::sqrt(it->second.var), 0.05);
+        best = std::max(best, std::abs(x - it->second.mean) / sd);
+    }
+    return best;
+}
+
+nlohmann::json StreamingAnomalyDetector::batch_json(const std::vector<Record>& records, size_t top) const {
+    std::vector<std::pair<double, size_t>> scored(records.size());
+    size_t above = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        scored[i] = {score(records[i]), i};
+        if (scored[i].first > threshold) above++;
+    }
+    top = std::min(top, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + top, scored.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    nlohmann::json j = {{"scored", records.size()}, {"above_threshold", above}, {"top", nlohmann::json::array()}};
+    for (size_t k = 0; k < top && scored[k].first > 0.0; ++k) {
+        const Record& r = records[scored[k].second];
+        j["top"].push_back({{"record", scored[k].second}, {"time", r.time}, {"type", r.type},
+                            {"product", r.product_name}, {"amount", r.amount}, {"z", scored[k].first}});
+    }
+    return j;
+}
+
+nlohmann::json StreamingAnomalyDetector::state() const {
+    // 每组存为 [mean, var, n]
+    auto pack = [](const GroupMap& groups) {
+        nlohmann::json j = nlohmann::json::object();
+        for (const auto& [key, s] : groups) j[key] = {s.mean, s.var, s.n};
+        return j;
+    };
+    return {{"alpha", alpha}, {"z_threshold", threshold}, {"warmup", warmup},
+            {"observed", n_seen}, {"alerts", n_alerts}, {"digest", digest}, {"first_digest", first_digest},
+            {"category", pack(by_category)}, {"product", pack(by_product)}};
+}
+
+bool StreamingAnomalyDetector::resume(const nlohmann::json& j) {
+    Snapshot loaded;
+    try {
+        if (!j.is_object() || j.at("alpha").get<double>() != alpha || j.at("z_threshold").get<double>() != threshold ||
+            j.at("warmup").get<size_t>() != warmup) return false;
+        loaded.observed = j.at("observed").get<size_t>();
+        loaded.alerts = j.at("alerts").get<size_t>();
+        loaded.digest = j.at("digest").get<uint64_t>();
+        loaded.first_digest = j.at("first_digest").get<uint64_t>();
+        for (auto [name, groups] : {std::pair{"category", &loaded.by_category}, std::pair{"product", &loaded.by_product}}) {
+            for (const auto& [key, v] : j.at(name).items()) {
+                (*groups)[key] = {v.at(0).get<double>(), v.at(1).get<double>(), v.at(2).get<size_t>()};
+            }
+        }
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+    if (loaded.observed == 0 || n_seen > 0) return false;
+    saved = std::move(loaded);
+    has_saved = true;
+    return true;
+}
+
+nlohmann::json StreamingAnomalyDetector::to_json() const {
+    nlohmann::json j;
+    j["observed"] = n_seen;
+    j["alpha"] = alpha;
+    j["z_threshold"] = threshold;
+    j["warmup"] = warmup;
+    j["groups"] = {{"category", by_category.size()}, {"product", by_product.size()}};
+    j["alert_count"] = n_alerts;
+    j["alerts_kept"] = emitted.size();
+    j["alerts"] = nlohmann::json::array();
+    for (const auto& a : emitted) j["alerts"].push_back(a.to_json());
+    return j;
+}
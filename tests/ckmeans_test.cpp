@@ -0,0 +1,80 @@
+// Ckmeans.1d.dp 与暴力枚举对照：随机小规模输入上枚举有序金额的全部切分点，
+// 最小组内平方和应与 ClusterAnalyzer::kmeans_cluster 的结果一致，簇按平均金额降序编号。
+// 运行：make test
+#include "../include/cluster_analyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+double sse(const std::vector<double>& v, size_t begin, size_t end) {
+    double mean = 0.0;
+    for (size_t i = begin; i < end; ++i) mean += v[i];
+    mean /= static_cast<double>(end - begin);
+    double s = 0.0;
+    for (size_t i = begin; i < end; ++i) s += (v[i] - mean) * (v[i] - mean);
+    return s;
+}
+
+// 一维 k-means 的最优解必由有序序列的连续段构成：枚举 k-1 个切分点
+double brute_force(const std::vector<double>& sorted, int k, size_t begin = 0) {
+    const size_t n = sorted.size();
+    if (k == 1) return sse(sorted, begin, n);
+    double best = INFINITY;
+    for (size_t cut = begin + 1; cut + (k - 1) <= n; ++cut) {
+        best = std::min(best, sse(sorted, begin, cut) + brute_force(sorted, k - 1, cut));
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(20240601);
+    ClusterAnalyzer analyzer;
+    int failures = 0, cases = 0;
+    for (int trial = 0; trial < 400; ++trial) {
+        const size_t n = 1 + rng() % 14;
+        const int k = 1 + static_cast<int>(rng() % 5);
+        // 混合连续金额、整数金额（大量重复）与负值（退款）
+        std::vector<Record> records(n);
+        for (auto& r : records) {
+            switch (rng() % 3) {
+            case 0: r.amount = std::uniform_real_distribution<double>(-50.0, 500.0)(rng); break;
+            case 1: r.amount = static_cast<double>(rng() % 4) * 10.0; break;
+            default: r.amount = std::exp(std::uniform_real_distribution<double>(0.0, 9.0)(rng)); break;
+            }
+        }
+        std::vector<ClusterInfo> clusters = analyzer.kmeans_cluster(records, k);
+        ++cases;
+
+        std::vector<double> sorted;
+        for (const auto& r : records) sorted.push_back(r.amount);
+        std::sort(sorted.begin(), sorted.end());
+        const int used = std::min<int>(k, static_cast<int>(n));
+        const double expected = brute_force(sorted, used);
+
+        double got = 0.0, scale = 1.0;
+        size_t members = 0;
+        bool ordered = true;
+        for (size_t c = 0; c < clusters.size(); ++c) {
+            std::vector<double> v;
+            for (size_t i : clusters[c].member_indices) v.push_back(records[i].amount);
+            members += v.size();
+            if (!v.empty()) got += sse(v, 0, v.size());
+            if (c > 0 && !clusters[c].member_indices.empty() && clusters[c].avg_amount > clusters[c - 1].avg_amount) ordered = false;
+        }
+        for (double v : sorted) scale = std::max(scale, v * v);
+        const bool optimal = std::abs(got - expected) <= 1e-9 * scale * n;
+        if (clusters.size() != static_cast<size_t>(k) || members != n || !ordered || !optimal) {
+            std::printf("FAIL trial %d: n=%zu k=%d sse=%.12g brute=%.12g members=%zu ordered=%d\n",
+                        trial, n, k, got, expected, members, ordered);
+            ++failures;
+        }
+    }
+    std::printf("ckmeans_test: %d/%d passed\n", cases - failures, cases);
+    return failures == 0 ? 0 : 1;
+}